@@ -3,6 +3,7 @@
 #include <imgui.h>
 #include <imgui_impl_glfw_gl3.h>
 #include <iostream>
+#include "thick_lines.h"
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow *window);
@@ -132,6 +133,15 @@ int main()
 
 	glUseProgram(shaderProgram);
 
+	// glLineWidth(9.0) may do nothing in a core profile, so the lines are drawn as quads
+	ThickLines thick;
+	float linePoints[8];
+	for (int i = 0; i < 4; i++) {
+		linePoints[2 * i] = vertices[3 * i];
+		linePoints[2 * i + 1] = vertices[3 * i + 1];
+	}
+	const float lineColor[4] = { 1.0f, 0.5f, 0.2f, 1.0f };
+
 	bool isPoints = true;
 	bool isLines = false;
 	bool isLine_Strip = false;
@@ -157,15 +167,9 @@ int main()
 			glPointSize(9.0);
 			glDrawArrays(GL_POINTS, 0, 4);
 		}
-		// draw lines
-		if (isLines) {
-			glLineWidth(9.0);
-			glDrawArrays(GL_LINES, 0, 4);
-		}
-		// draw line strip
-		if (isLine_Strip) {
-			glLineWidth(9.0);
-			glDrawArrays(GL_LINE_STRIP, 0, 4);
+		// draw lines / line strip, 9 pixels wide
+		if (isLines || isLine_Strip) {
+			thick.draw(9.0f, ThickLines::JOIN_MITER, lineColor);
 		}
 		// glBindVertexArray(0); // no need to unbind it every time 
 
@@ -181,11 +185,13 @@ int main()
 			isPoints = false;
 			isLines = true;
 			isLine_Strip = false;
+			thick.setSegments(linePoints, 2);
 		}
 		if (ImGui::Button("Line Strip")) {
 			isPoints = false;
 			isLines = false;
 			isLine_Strip = true;
+			thick.setStrip(linePoints, 4, false);
 		}
 		ImGui::End();
 		ImGui::Render();
@@ -200,6 +206,7 @@ int main()
 	// optional: de-allocate all resources once they've outlived their purpose:
 	glDeleteVertexArrays(1, &VAO);
 	glDeleteBuffers(1, &VBO);
+	thick.release();
 
 	// glfw: terminate, clearing all previously allocated GLFW resources.
 	ImGui_ImplGlfwGL3_Shutdown();
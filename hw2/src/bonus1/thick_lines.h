@@ -0,0 +1,267 @@
+#ifndef THICK_LINES_H
+#define THICK_LINES_H
+
+#include <glad/glad.h>
+#include <iostream>
+#include <vector>
+
+// Wide lines for a core profile context, where glLineWidth above 1 is allowed to do nothing
+// (and does nothing on Mesa). Every segment is one instance of a 4 vertex triangle strip; the
+// vertex shader turns it into a screen-space quad around the segment from gl_VertexID, so no
+// per-vertex data exists at all and any number of segments is a single glDrawArraysInstanced.
+//
+// The instance data is the point list itself. An instance reads four consecutive points
+// (previous, start, end, next) through four attributes at increasing offsets with divisor 1,
+// so neighbouring segments of a strip compute the same miter vertices at their shared point
+// and meet without gaps or overlap. For separate segments previous == start and next == end,
+// which the shader takes as "no neighbour". Round joins need no neighbours: every segment gets
+// round caps (the fragment shader cuts the quad down to the points within half the width).
+// Edges are anti-aliased over one pixel from the distance to the segment.
+//
+// Needs a current GL context when constructed, like the Shader class, and release() while
+// the context still exists.
+class ThickLines
+{
+public:
+	enum Join { JOIN_MITER, JOIN_ROUND };
+
+	ThickLines() : Program(0), Buffer(0), Capacity(0), Instances(0), IsStrip(false)
+	{
+		Program = createProgram();
+		Transform[0] = Transform[1] = 1.0f;
+		Transform[2] = Transform[3] = 0.0f;
+		glGenBuffers(1, &Buffer);
+		glGenVertexArrays(2, VAO);
+		// separate segments: pairs of points, previous / next repeat start / end
+		setupVAO(VAO[0], 4 * sizeof(float), 0, 0, 2, 2);
+		// strips: one point after the other, the attributes are the points i .. i + 3
+		setupVAO(VAO[1], 2 * sizeof(float), 0, 2, 4, 6);
+		TransformLoc = glGetUniformLocation(Program, "transform");
+		ViewportLoc = glGetUniformLocation(Program, "viewport");
+		HalfWidthLoc = glGetUniformLocation(Program, "halfWidth");
+		JoinLoc = glGetUniformLocation(Program, "join");
+		ColorLoc = glGetUniformLocation(Program, "color");
+	}
+	// frees the GL objects; call it before the context goes away (glfwTerminate)
+	void release()
+	{
+		glDeleteVertexArrays(2, VAO);
+		glDeleteBuffers(1, &Buffer);
+		glDeleteProgram(Program);
+	}
+
+	// the input coordinates become NDC as xy * (sx, sy) + (ox, oy); identity by default
+	void setTransform(float sx, float sy, float ox, float oy)
+	{
+		Transform[0] = sx;
+		Transform[1] = sy;
+		Transform[2] = ox;
+		Transform[3] = oy;
+	}
+
+	// segments (x1, y1, x2, y2) like GL_LINES
+	void setSegments(const float* xy, int segments)
+	{
+		IsStrip = false;
+		Instances = segments > 0 ? segments : 0;
+		upload(xy, 4 * Instances);
+	}
+
+	// count points (x, y) like GL_LINE_STRIP, or GL_LINE_LOOP when closed
+	void setStrip(const float* xy, int count, bool closed)
+	{
+		IsStrip = true;
+		Points.clear();
+		if (count < 2) {
+			Instances = 0;
+			return;
+		}
+		// an open strip repeats its end points (no neighbour there); a closed one wraps around
+		if (closed)
+			Points.insert(Points.end(), xy + 2 * (count - 1), xy + 2 * count);
+		else
+			Points.insert(Points.end(), xy, xy + 2);
+		Points.insert(Points.end(), xy, xy + 2 * count);
+		if (closed)
+			Points.insert(Points.end(), xy, xy + 4);
+		else
+			Points.insert(Points.end(), xy + 2 * (count - 1), xy + 2 * count);
+		Instances = closed ? count : count - 1;
+		upload(&Points[0], (int)Points.size());
+	}
+
+	int segments() const
+	{
+		return Instances;
+	}
+
+	// width in pixels, color as RGBA 0..1; leaves the program and VAO bound and blending off
+	void draw(float width, Join join, const float color[4])
+	{
+		if (Instances == 0)
+			return;
+		GLint viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		glUseProgram(Program);
+		glUniform4fv(TransformLoc, 1, Transform);
+		glUniform2f(ViewportLoc, float(viewport[2]), float(viewport[3]));
+		glUniform1f(HalfWidthLoc, width * 0.5f);
+		glUniform1i(JoinLoc, join);
+		glUniform4fv(ColorLoc, 1, color);
+		glBindVertexArray(VAO[IsStrip ? 1 : 0]);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, Instances);
+		glDisable(GL_BLEND);
+	}
+
+private:
+	GLuint Program;
+	GLuint Buffer;
+	GLuint VAO[2];
+	size_t Capacity;
+	int Instances;
+	bool IsStrip;
+	float Transform[4];
+	std::vector<float> Points;
+	GLint TransformLoc, ViewportLoc, HalfWidthLoc, JoinLoc, ColorLoc;
+
+	// attributes 0..3 = previous, start, end, next point at the given float offsets
+	void setupVAO(GLuint vao, GLsizei stride, int prev, int start, int end, int next)
+	{
+		int offsets[4] = { prev, start, end, next };
+		glBindVertexArray(vao);
+		glBindBuffer(GL_ARRAY_BUFFER, Buffer);
+		for (int i = 0; i < 4; i++) {
+			glVertexAttribPointer(i, 2, GL_FLOAT, GL_FALSE, stride, (void*)(offsets[i] * sizeof(float)));
+			glVertexAttribDivisor(i, 1);
+			glEnableVertexAttribArray(i);
+		}
+		glBindVertexArray(0);
+	}
+
+	// grows the buffer geometrically, otherwise only updates the bytes in use
+	void upload(const float* data, int floats)
+	{
+		size_t bytes = floats * sizeof(float);
+		glBindBuffer(GL_ARRAY_BUFFER, Buffer);
+		if (bytes > Capacity) {
+			size_t capacity = Capacity ? Capacity : 4096;
+			while (capacity < bytes)
+				capacity *= 2;
+			glBufferData(GL_ARRAY_BUFFER, capacity, NULL, GL_DYNAMIC_DRAW);
+			Capacity = capacity;
+		}
+		if (bytes > 0)
+			glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, data);
+	}
+
+	static GLuint createProgram()
+	{
+		static const char* vertexSource = "#version 330 core\n"
+			"layout (location = 0) in vec2 aPrev;\n"
+			"layout (location = 1) in vec2 aStart;\n"
+			"layout (location = 2) in vec2 aEnd;\n"
+			"layout (location = 3) in vec2 aNext;\n"
+			"uniform vec4 transform;\n"
+			"uniform vec2 viewport;\n"
+			"uniform float halfWidth;\n"
+			"uniform int join;\n"
+			"out vec2 local;\n"          // pixels along / across the segment from its start
+			"flat out float segLength;\n"
+			"vec2 toPixels(vec2 p)\n"
+			"{\n"
+			"   return ((p * transform.xy + transform.zw) * 0.5 + 0.5) * viewport;\n"
+			"}\n"
+			"vec2 direction(vec2 d)\n"
+			"{\n"
+			"   return dot(d, d) > 0.0 ? normalize(d) : vec2(1.0, 0.0);\n"
+			"}\n"
+			// offset of the left corner at a joint entering along d0 and leaving along d1;
+			// symmetric in d0 and d1 so both segments get the same vertex. Turns sharper than
+			// the miter limit (4 half widths) fall back to a butt end
+			"vec2 miter(vec2 d0, vec2 d1, vec2 n, float e)\n"
+			"{\n"
+			"   vec2 s = d0 + d1;\n"
+			"   float c = length(s) * 0.5;\n"  // cosine of half the turn
+			"   if (c < 0.25) return n * e;\n"
+			"   vec2 t = s / (2.0 * c);\n"
+			"   return vec2(-t.y, t.x) * (e / c);\n"
+			"}\n"
+			"void main()\n"
+			"{\n"
+			"   vec2 a = toPixels(aStart), b = toPixels(aEnd);\n"
+			"   vec2 dir = direction(b - a);\n"
+			"   vec2 n = vec2(-dir.y, dir.x);\n"
+			"   float e = halfWidth + 1.0;\n"  // one more pixel for the anti-aliased edge
+			"   bool atEnd = (gl_VertexID & 1) != 0;\n"
+			"   float side = (gl_VertexID & 2) != 0 ? 1.0 : -1.0;\n"
+			"   vec2 p = atEnd ? b : a;\n"
+			"   vec2 offset = n * e;\n"
+			"   if (join == 1)\n"
+			"      p += dir * (atEnd ? e : -e);\n"
+			"   else if (!atEnd && aPrev != aStart)\n"
+			"      offset = miter(direction(a - toPixels(aPrev)), dir, n, e);\n"
+			"   else if (atEnd && aNext != aEnd)\n"
+			"      offset = miter(dir, direction(toPixels(aNext) - b), n, e);\n"
+			"   p += offset * side;\n"
+			"   local = vec2(dot(p - a, dir), dot(p - a, n));\n"
+			"   segLength = length(b - a);\n"
+			"   gl_Position = vec4(p / viewport * 2.0 - 1.0, 0.0, 1.0);\n"
+			"}\0";
+		static const char* fragmentSource = "#version 330 core\n"
+			"in vec2 local;\n"
+			"flat in float segLength;\n"
+			"uniform float halfWidth;\n"
+			"uniform int join;\n"
+			"uniform vec4 color;\n"
+			"out vec4 FragColor;\n"
+			"void main()\n"
+			"{\n"
+			// distance to the segment for round caps, to its line otherwise
+			"   float d = abs(local.y);\n"
+			"   if (join == 1)\n"
+			"      d = length(vec2(local.x - clamp(local.x, 0.0, segLength), local.y));\n"
+			"   float alpha = clamp(halfWidth + 0.5 - d, 0.0, 1.0);\n"
+			"   if (alpha <= 0.0)\n"
+			"      discard;\n"
+			"   FragColor = vec4(color.rgb, color.a * alpha);\n"
+			"}\n\0";
+
+		GLuint vertex = compile(GL_VERTEX_SHADER, vertexSource, "VERTEX");
+		GLuint fragment = compile(GL_FRAGMENT_SHADER, fragmentSource, "FRAGMENT");
+		GLuint program = glCreateProgram();
+		glAttachShader(program, vertex);
+		glAttachShader(program, fragment);
+		glLinkProgram(program);
+		int success;
+		char infoLog[512];
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		if (!success) {
+			glGetProgramInfoLog(program, 512, NULL, infoLog);
+			std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+		}
+		glDeleteShader(vertex);
+		glDeleteShader(fragment);
+		return program;
+	}
+
+	static GLuint compile(GLenum type, const char* source, const char* name)
+	{
+		GLuint shader = glCreateShader(type);
+		glShaderSource(shader, 1, &source, NULL);
+		glCompileShader(shader);
+		int success;
+		char infoLog[512];
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+		if (!success) {
+			glGetShaderInfoLog(shader, 512, NULL, infoLog);
+			std::cout << "ERROR::SHADER::" << name << "::COMPILATION_FAILED\n" << infoLog << std::endl;
+		}
+		return shader;
+	}
+
+	ThickLines(const ThickLines&);
+	ThickLines& operator=(const ThickLines&);
+};
+#endif
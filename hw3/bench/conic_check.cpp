@@ -0,0 +1,184 @@
+// Headless consistency checks for the hw3 conic kernels (no window / GL needed).
+//
+// build: g++ -O2 -std=c++11 -I../src conic_check.cpp -o conic_check
+// run:   conic_check
+//
+// Compares the filled shapes against their outlines row by row, the degenerate ellipses
+// against the segments they should be, and the clipped shapes against the unclipped ones.
+// Prints the first failures and exits with 1 if there was any.
+#include <cstdio>
+#include <map>
+#include <set>
+#include <utility>
+#include "clip.h"
+#include "conic.h"
+
+using namespace std;
+
+int failures = 0;
+
+void fail(const char* what, int a, int b) {
+	if (failures < 20)
+		printf("FAIL %s (%d, %d)\n", what, a, b);
+	failures++;
+}
+
+// every pixel emitted, plus how many were emitted twice and the spans per row
+struct PixelTarget
+{
+	set<pair<int, int> > Pixels;
+	map<int, int> RowSpans;
+	int Repeats;
+	PixelTarget() : Repeats(0) {}
+	void point(int x, int y)
+	{
+		if (!Pixels.insert(make_pair(x, y)).second)
+			Repeats++;
+	}
+	void span(int x0, int y0, int x1, int y1)
+	{
+		if (y0 == y1)
+			RowSpans[y0]++;
+		for (int y = y0; y <= y1; y++)
+			for (int x = x0; x <= x1; x++)
+				point(x, y);
+	}
+
+	// leftmost and rightmost pixel of every row
+	map<int, pair<int, int> > rowExtents() const
+	{
+		map<int, pair<int, int> > rows;
+		for (set<pair<int, int> >::const_iterator it = Pixels.begin(); it != Pixels.end(); ++it) {
+			map<int, pair<int, int> >::iterator row = rows.find(it->second);
+			if (row == rows.end())
+				rows[it->second] = make_pair(it->first, it->first);
+			else
+				row->second.second = it->first;
+		}
+		return rows;
+	}
+};
+
+// fillDisc runs between the outline pixels on every row drawCircle has pixels in; the rows the
+// outline skips at the diagonal take the extent of the row just outside them
+void checkDisc(int r) {
+	PixelTarget outline, disc;
+	drawCircle(outline, 0, 0, r);
+	fillDisc(disc, 0, 0, r);
+	map<int, pair<int, int> > o = outline.rowExtents(), d = disc.rowExtents();
+	if (disc.Repeats != 0)
+		fail("fillDisc emits a pixel twice, r", r, disc.Repeats);
+	for (int y = -r; y <= r && r > 0; y++) {
+		if (d.find(y) == d.end()) {
+			fail("fillDisc leaves a row empty, r / row", r, y);
+			continue;
+		}
+		if (disc.RowSpans[y] != 1)
+			fail("fillDisc row is not one span, r / row", r, y);
+		map<int, pair<int, int> >::iterator row = o.find(y);
+		if (row == o.end()) {
+			row = o.find(y > 0 ? y + 1 : y - 1);
+			if (row == o.end() || row->second != d[y])
+				fail("fillDisc gap row differs from the row outside it, r / row", r, y);
+		}
+		else if (row->second != d[y]) {
+			fail("fillDisc row extent differs from drawCircle, r / row", r, y);
+		}
+	}
+	if ((int)d.size() != (r > 0 ? 2 * r + 1 : 0))
+		fail("fillDisc has rows outside the radius, r", r, (int)d.size());
+}
+
+// filled ellipses are bounded by the outline the same way
+void checkEllipse(int rx, int ry) {
+	PixelTarget outline, fill;
+	drawEllipse(outline, 0, 0, rx, ry, false);
+	fillEllipse(fill, 0, 0, rx, ry);
+	map<int, pair<int, int> > o = outline.rowExtents(), f = fill.rowExtents();
+	if (fill.Repeats != 0 || outline.Repeats != 0)
+		fail("ellipse emits a pixel twice, rx / ry", rx, ry);
+	if (o != f)
+		fail("fillEllipse row extents differ from drawEllipse, rx / ry", rx, ry);
+}
+
+// an ellipse with a zero semi-axis is exactly the segment along the other one, in every mode
+void checkFlatEllipse(int rx, int ry) {
+	set<pair<int, int> > expected;
+	for (int y = -ry; y <= ry; y++)
+		for (int x = -rx; x <= rx; x++)
+			expected.insert(make_pair(x, y));
+	PixelTarget points, spans, fill;
+	drawEllipse(points, 0, 0, rx, ry, false);
+	drawEllipse(spans, 0, 0, rx, ry, true);
+	fillEllipse(fill, 0, 0, rx, ry);
+	if (points.Pixels != expected || points.Repeats != 0)
+		fail("drawEllipse points of a flat ellipse, rx / ry", rx, ry);
+	if (spans.Pixels != expected || spans.Repeats != 0)
+		fail("drawEllipse spans of a flat ellipse, rx / ry", rx, ry);
+	if (fill.Pixels != expected || fill.Repeats != 0)
+		fail("fillEllipse of a flat ellipse, rx / ry", rx, ry);
+}
+
+// through ClipTarget a shape keeps exactly its pixels inside the rectangle, and the others
+// are counted as saved
+template <typename Draw>
+void checkClipped(const char* what, Draw draw) {
+	PixelTarget full, clipped;
+	ClipRect clip(-20, -10, 35, 25);
+	ClipTarget<PixelTarget> target(clipped, clip);
+	draw(full);
+	draw(target);
+	set<pair<int, int> > inside;
+	for (set<pair<int, int> >::iterator it = full.Pixels.begin(); it != full.Pixels.end(); ++it)
+		if (clip.contains(it->first, it->second))
+			inside.insert(*it);
+	if (clipped.Pixels != inside)
+		fail(what, (int)clipped.Pixels.size(), (int)inside.size());
+	if (clip.Saved != (long long)(full.Pixels.size() + full.Repeats - clipped.Pixels.size() - clipped.Repeats))
+		fail(what, (int)clip.Saved, (int)(full.Pixels.size() - clipped.Pixels.size()));
+}
+
+struct DiscAt
+{
+	template <typename Target> void operator()(Target& t) const { fillDisc(t, 10, 5, 40); }
+};
+struct EllipseAt
+{
+	bool Spans;
+	template <typename Target> void operator()(Target& t) const { drawEllipse(t, -5, 0, 60, 17, Spans); }
+};
+struct FilledEllipseAt
+{
+	template <typename Target> void operator()(Target& t) const { fillEllipse(t, 0, 20, 13, 45); }
+};
+struct ArcAt
+{
+	bool Spans;
+	template <typename Target> void operator()(Target& t) const { drawArc(t, 0, 0, 50, 30, 300, Spans); }
+};
+
+int main() {
+	for (int r = 0; r < 300; r++)
+		checkDisc(r);
+	for (int rx = 1; rx < 40; rx++)
+		for (int ry = 1; ry < 40; ry++)
+			checkEllipse(rx, ry);
+	for (int r = 0; r < 50; r++) {
+		checkFlatEllipse(r, 0);
+		checkFlatEllipse(0, r);
+	}
+	checkClipped("clipped fillDisc", DiscAt());
+	for (int spans = 0; spans < 2; spans++) {
+		EllipseAt ellipse = { spans != 0 };
+		ArcAt arc = { spans != 0 };
+		checkClipped("clipped drawEllipse", ellipse);
+		checkClipped("clipped drawArc", arc);
+	}
+	checkClipped("clipped fillEllipse", FilledEllipseAt());
+
+	if (failures == 0)
+		printf("all conic checks passed\n");
+	else
+		printf("%d conic checks failed\n", failures);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,486 @@
+// Headless throughput benchmark for the hw3 rasterization kernels (no window / GL needed).
+//
+// build: g++ -O2 -std=c++11 -pthread -I../src rasterizer_bench.cpp -o rasterizer_bench
+//        (add -mavx2 for the AVX2 version of the anti-aliased line kernel)
+// run:   rasterizer_bench [--json] [--out file] [--quick]
+//
+// Every kernel is run against the targets the program uses (the int16 vertex buffer and the
+// CPU framebuffer) across line slopes and lengths, circle radii and polygon sizes, and
+// reported as Mpixels/s and ns per primitive. --json prints the results as JSON so they can be tracked
+// across releases; --out writes the same JSON to a file.
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "aa_line.h"
+#include "bresenham.h"
+#include "clip.h"
+#include "conic.h"
+#include "framebuffer.h"
+#include "line_batch.h"
+#include "point_buffer.h"
+#include "polygon_fill.h"
+#include "tile_raster.h"
+
+using namespace std;
+
+const int CANVAS = 1024;
+const int BATCH = 256;
+
+struct Result
+{
+	string kernel;
+	string target;
+	string params;
+	long long primitives;
+	long long pixels;
+	double seconds;
+};
+
+vector<Result> results;
+double minSeconds = 0.2;
+
+// counts pixels without storing them, to know how much work one batch is
+struct CountTarget
+{
+	long long Pixels;
+	CountTarget() : Pixels(0) {}
+	void point(int, int) { Pixels++; }
+	void span(int x0, int y0, int x1, int y1) { Pixels += (x1 - x0) + (y1 - y0) + 1; }
+};
+
+// keep calling batch() until minSeconds have passed; returns seconds per call
+template <typename F>
+double timeBatch(F batch) {
+	typedef chrono::steady_clock clock;
+	batch();
+	long long calls = 0;
+	clock::time_point start = clock::now();
+	double elapsed = 0.0;
+	do {
+		batch();
+		calls++;
+		elapsed = chrono::duration<double>(clock::now() - start).count();
+	} while (elapsed < minSeconds);
+	return elapsed / calls;
+}
+
+void record(const char* kernel, const char* target, const string& params, long long primitives, long long pixels, double seconds) {
+	Result r;
+	r.kernel = kernel;
+	r.target = target;
+	r.params = params;
+	r.primitives = primitives;
+	r.pixels = pixels;
+	r.seconds = seconds;
+	results.push_back(r);
+}
+
+// segments of one slope and length, spread over the canvas so they stay on screen
+vector<Segment> makeLines(double degrees, int length) {
+	vector<Segment> lines(BATCH);
+	double rad = degrees * 3.14159265358979 / 180.0;
+	int dx = int(floor(cos(rad) * length + 0.5)), dy = int(floor(sin(rad) * length + 0.5));
+	for (int i = 0; i < BATCH; i++) {
+		int x = (i * 37) % (CANVAS - length > 0 ? CANVAS - length : 1);
+		int y = (i * 53) % (CANVAS - length > 0 ? CANVAS - length : 1);
+		lines[i].x1 = x;
+		lines[i].y1 = y;
+		lines[i].x2 = x + dx;
+		lines[i].y2 = y + dy;
+	}
+	return lines;
+}
+
+void benchLines(double degrees, int length) {
+	vector<Segment> lines = makeLines(degrees, length);
+	char params[64];
+	sprintf(params, "slope=%g length=%d", degrees, length);
+
+	CountTarget counter;
+	for (int i = 0; i < BATCH; i++)
+		drawLine(counter, lines[i].x1, lines[i].y1, lines[i].x2, lines[i].y2);
+	long long pixels = counter.Pixels;
+
+	PointBuffer buffer;
+	Framebuffer framebuffer;
+	framebuffer.resize(CANVAS, CANVAS);
+	ClipRect clip(CANVAS / 2, CANVAS / 2);
+
+	double t = timeBatch([&] {
+		buffer.clear();
+		PointTarget target(buffer);
+		for (int i = 0; i < BATCH; i++)
+			drawLine(target, lines[i].x1, lines[i].y1, lines[i].x2, lines[i].y2);
+	});
+	record("drawLine", "points", params, BATCH, pixels, t);
+
+	t = timeBatch([&] {
+		buffer.clear();
+		PointTarget target(buffer);
+		for (int i = 0; i < BATCH; i++)
+			drawLineSpan(target, lines[i].x1, lines[i].y1, lines[i].x2, lines[i].y2);
+	});
+	record("drawLineSpan", "spans", params, BATCH, pixels, t);
+
+	t = timeBatch([&] {
+		for (int i = 0; i < BATCH; i++)
+			drawLine(framebuffer, lines[i].x1, lines[i].y1, lines[i].x2, lines[i].y2);
+	});
+	record("drawLine", "framebuffer", params, BATCH, pixels, t);
+
+	t = timeBatch([&] {
+		for (int i = 0; i < BATCH; i++)
+			drawLineSpan(framebuffer, lines[i].x1, lines[i].y1, lines[i].x2, lines[i].y2);
+	});
+	record("drawLineSpan", "framebuffer", params, BATCH, pixels, t);
+
+	// a quarter of the canvas is visible, the rest is clipped away
+	t = timeBatch([&] {
+		buffer.clear();
+		PointTarget target(buffer);
+		for (int i = 0; i < BATCH; i++)
+			drawLineClipped(target, clip, lines[i].x1, lines[i].y1, lines[i].x2, lines[i].y2, false);
+	});
+	record("drawLineClipped", "points", params, BATCH, pixels, t);
+
+	// Wu lines write two pixels per step plus coverage; pixels counts steps as for drawLine
+	vector<unsigned char> coverage;
+	t = timeBatch([&] {
+		buffer.clear();
+		coverage.clear();
+		for (int i = 0; i < BATCH; i++)
+			drawLineAA(buffer, coverage, lines[i].x1, lines[i].y1, lines[i].x2, lines[i].y2);
+	});
+	record("drawLineAA", "points+coverage", params, BATCH, pixels, t);
+}
+
+void benchCircles(int radius) {
+	char params[64];
+	sprintf(params, "radius=%d", radius);
+	int cx = CANVAS / 2, cy = CANVAS / 2;
+
+	CountTarget counter;
+	for (int i = 0; i < BATCH; i++)
+		drawCircle(counter, cx + i % 7, cy + i % 5, radius);
+	long long pixels = counter.Pixels;
+
+	PointBuffer buffer;
+	Framebuffer framebuffer;
+	framebuffer.resize(CANVAS, CANVAS);
+	ClipRect clip(CANVAS / 2, CANVAS / 2);
+
+	double t = timeBatch([&] {
+		buffer.clear();
+		PointTarget target(buffer);
+		for (int i = 0; i < BATCH; i++)
+			drawCircle(target, cx + i % 7, cy + i % 5, radius);
+	});
+	record("drawCircle", "points", params, BATCH, pixels, t);
+
+	t = timeBatch([&] {
+		buffer.clear();
+		PointTarget target(buffer);
+		for (int i = 0; i < BATCH; i++)
+			drawCircleSpan(target, cx + i % 7, cy + i % 5, radius);
+	});
+	record("drawCircleSpan", "spans", params, BATCH, pixels, t);
+
+	t = timeBatch([&] {
+		for (int i = 0; i < BATCH; i++)
+			drawCircle(framebuffer, cx + i % 7, cy + i % 5, radius);
+	});
+	record("drawCircle", "framebuffer", params, BATCH, pixels, t);
+
+	t = timeBatch([&] {
+		buffer.clear();
+		PointTarget target(buffer);
+		for (int i = 0; i < BATCH; i++)
+			drawCircleClipped(target, clip, cx + i % 7, cy + i % 5, radius, false);
+	});
+	record("drawCircleClipped", "points", params, BATCH, pixels, t);
+
+	// filled shapes count the pixels they fill
+	CountTarget discCounter;
+	for (int i = 0; i < BATCH; i++)
+		fillDisc(discCounter, cx + i % 7, cy + i % 5, radius);
+	t = timeBatch([&] {
+		buffer.clear();
+		PointTarget target(buffer);
+		for (int i = 0; i < BATCH; i++)
+			fillDisc(target, cx + i % 7, cy + i % 5, radius);
+	});
+	record("fillDisc", "spans", params, BATCH, discCounter.Pixels, t);
+	t = timeBatch([&] {
+		for (int i = 0; i < BATCH; i++)
+			fillDisc(framebuffer, cx + i % 7, cy + i % 5, radius);
+	});
+	record("fillDisc", "framebuffer", params, BATCH, discCounter.Pixels, t);
+
+	// ellipses twice as wide as high, and a three quarter arc
+	CountTarget ellipseCounter, fillCounter, arcCounter;
+	for (int i = 0; i < BATCH; i++) {
+		drawEllipse(ellipseCounter, cx + i % 7, cy + i % 5, radius, radius / 2, false);
+		fillEllipse(fillCounter, cx + i % 7, cy + i % 5, radius, radius / 2);
+		drawArc(arcCounter, cx + i % 7, cy + i % 5, radius, 30, 300, false);
+	}
+	t = timeBatch([&] {
+		buffer.clear();
+		PointTarget target(buffer);
+		for (int i = 0; i < BATCH; i++)
+			drawEllipse(target, cx + i % 7, cy + i % 5, radius, radius / 2, false);
+	});
+	record("drawEllipse", "points", params, BATCH, ellipseCounter.Pixels, t);
+	t = timeBatch([&] {
+		buffer.clear();
+		PointTarget target(buffer);
+		for (int i = 0; i < BATCH; i++)
+			drawEllipse(target, cx + i % 7, cy + i % 5, radius, radius / 2, true);
+	});
+	record("drawEllipse", "spans", params, BATCH, ellipseCounter.Pixels, t);
+	t = timeBatch([&] {
+		buffer.clear();
+		PointTarget target(buffer);
+		for (int i = 0; i < BATCH; i++)
+			fillEllipse(target, cx + i % 7, cy + i % 5, radius, radius / 2);
+	});
+	record("fillEllipse", "spans", params, BATCH, fillCounter.Pixels, t);
+	t = timeBatch([&] {
+		buffer.clear();
+		PointTarget target(buffer);
+		for (int i = 0; i < BATCH; i++)
+			drawArc(target, cx + i % 7, cy + i % 5, radius, 30, 300, false);
+	});
+	record("drawArc", "points", params, BATCH, arcCounter.Pixels, t);
+	t = timeBatch([&] {
+		buffer.clear();
+		PointTarget target(buffer);
+		for (int i = 0; i < BATCH; i++)
+			drawArc(target, cx + i % 7, cy + i % 5, radius, 30, 300, true);
+	});
+	record("drawArc", "spans", params, BATCH, arcCounter.Pixels, t);
+}
+
+void benchEightPoint() {
+	const int CALLS = BATCH * 64;
+	PointBuffer buffer;
+	double t = timeBatch([&] {
+		buffer.clear();
+		PointTarget target(buffer);
+		for (int i = 0; i < CALLS; i++)
+			drawEightPoint(target, CANVAS / 2, CANVAS / 2, i & 255, 256 + (i & 127));
+	});
+	record("drawEightPoint", "points", "", CALLS, 8LL * CALLS, t);
+}
+
+// random polygons (self-intersecting for sides > 3) around points of the canvas
+vector<int> makePolygons(int count, int sides, int size) {
+	vector<int> points(2 * count * sides);
+	srand(1234);
+	for (int i = 0; i < count; i++) {
+		int cx = size + (i * 37) % (CANVAS - 2 * size), cy = size + (i * 53) % (CANVAS - 2 * size);
+		for (int j = 0; j < sides; j++) {
+			points[2 * (sides * i + j)] = cx + rand() % (size + 1) - size / 2;
+			points[2 * (sides * i + j) + 1] = cy + rand() % (size + 1) - size / 2;
+		}
+	}
+	return points;
+}
+
+// scanline fill against drawing the same polygons as outlines only
+void benchPolygons(int sides, int size) {
+	const int COUNT = 2000;
+	vector<int> points = makePolygons(COUNT, sides, size);
+	char params[64];
+	sprintf(params, "sides=%d size=%d", sides, size);
+	ScanlineFill filler;
+	PointBuffer buffer;
+	Framebuffer framebuffer;
+	framebuffer.resize(CANVAS, CANVAS);
+
+	CountTarget counter;
+	for (int i = 0; i < COUNT; i++) {
+		const int* p = &points[2 * sides * i];
+		for (int j = 0; j < sides; j++) {
+			const int* q = &points[2 * (sides * i + (j + 1) % sides)];
+			drawLine(counter, p[2 * j], p[2 * j + 1], q[0], q[1]);
+		}
+	}
+	long long outlinePixels = counter.Pixels;
+	double t = timeBatch([&] {
+		buffer.clear();
+		PointTarget target(buffer);
+		for (int i = 0; i < COUNT; i++) {
+			const int* p = &points[2 * sides * i];
+			for (int j = 0; j < sides; j++) {
+				const int* q = &points[2 * (sides * i + (j + 1) % sides)];
+				drawLineSpan(target, p[2 * j], p[2 * j + 1], q[0], q[1]);
+			}
+		}
+	});
+	record("outline", "spans", params, COUNT, outlinePixels, t);
+
+	const FillRule rules[] = { FILL_EVEN_ODD, FILL_NON_ZERO };
+	const char* names[] = { "fillEvenOdd", "fillNonZero" };
+	for (int r = 0; r < 2; r++) {
+		long long pixels = 0;
+		for (int i = 0; i < COUNT; i++)
+			pixels += filler.pixelCount(&points[2 * sides * i], &sides, 1, rules[r]);
+		t = timeBatch([&] {
+			buffer.clear();
+			PointTarget target(buffer);
+			for (int i = 0; i < COUNT; i++)
+				filler.fillPolygon(target, &points[2 * sides * i], sides, rules[r]);
+		});
+		record(names[r], "spans", params, COUNT, pixels, t);
+		t = timeBatch([&] {
+			for (int i = 0; i < COUNT; i++)
+				filler.fillPolygon(framebuffer, &points[2 * sides * i], sides, rules[r]);
+		});
+		record(names[r], "framebuffer", params, COUNT, pixels, t);
+	}
+}
+
+// tile-binned triangles on 1..N threads against the scanline fill of the same triangles
+void benchTiles(int size) {
+	const int COUNT = 20000;
+	vector<int> points = makePolygons(COUNT, 3, size);
+	vector<Triangle> triangles(COUNT);
+	for (int i = 0; i < COUNT; i++) {
+		const int* p = &points[6 * i];
+		Triangle t = { p[0], p[1], p[2], p[3], p[4], p[5], Framebuffer::rgba(i & 255, 128, 51) };
+		triangles[i] = t;
+	}
+	char params[64];
+	Framebuffer framebuffer;
+	framebuffer.resize(CANVAS, CANVAS);
+	ScanlineFill filler;
+	ClipRect clip(CANVAS, CANVAS);
+	CountTarget counter;
+	for (int i = 0; i < COUNT; i++)
+		filler.fillPolygon(counter, &points[6 * i], 3, FILL_EVEN_ODD, &clip);
+	long long pixels = counter.Pixels;
+
+	sprintf(params, "size=%d", size);
+	double t = timeBatch([&] {
+		for (int i = 0; i < COUNT; i++) {
+			framebuffer.setColor(triangles[i].Color);
+			filler.fillPolygon(framebuffer, &points[6 * i], 3, FILL_EVEN_ODD, &clip);
+		}
+	});
+	record("fillEvenOdd", "framebuffer", params, COUNT, pixels, t);
+
+	TileRasterizer tiles;
+	for (unsigned int threads = 1; threads <= tiles.maxThreads(); threads++) {
+		sprintf(params, "size=%d threads=%u", size, threads);
+		t = timeBatch([&] {
+			tiles.drawTriangles(framebuffer, &triangles[0], COUNT, threads);
+		});
+		record("drawTriangles", "framebuffer", params, COUNT, pixels, t);
+	}
+}
+
+// LineBatch scaling: the same 64k segments on 1..N threads
+void benchBatch() {
+	const int COUNT = 65536;
+	vector<Segment> lines(COUNT);
+	for (int i = 0; i < COUNT; i++) {
+		lines[i].x1 = (i * 37) % CANVAS;
+		lines[i].y1 = (i * 53) % CANVAS;
+		lines[i].x2 = lines[i].x1 + (i * 7) % 129 - 64;
+		lines[i].y2 = lines[i].y1 + (i * 11) % 129 - 64;
+	}
+	long long pixels = LineBatch::pixelCount(&lines[0], COUNT);
+	LineBatch batch;
+	PointBuffer buffer;
+	for (unsigned int threads = 1; threads <= batch.maxThreads(); threads++) {
+		char params[64];
+		sprintf(params, "threads=%u", threads);
+		double t = timeBatch([&] {
+			batch.drawLines(buffer, &lines[0], COUNT, false, threads);
+		});
+		record("drawLines", "points", params, COUNT, pixels, t);
+	}
+	vector<unsigned char> coverage;
+	for (unsigned int threads = 1; threads <= batch.maxThreads(); threads++) {
+		char params[64];
+		sprintf(params, "threads=%u", threads);
+		double t = timeBatch([&] {
+			batch.drawLinesAA(buffer, coverage, &lines[0], COUNT, threads);
+		});
+		record("drawLinesAA", "points+coverage", params, COUNT, pixels, t);
+	}
+}
+
+void printTable() {
+	printf("%-18s %-16s %-24s %12s %14s\n", "kernel", "target", "params", "Mpixels/s", "ns/primitive");
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result& r = results[i];
+		printf("%-18s %-16s %-24s %12.1f %14.1f\n", r.kernel.c_str(), r.target.c_str(), r.params.c_str(),
+			r.pixels / r.seconds / 1e6, r.seconds / r.primitives * 1e9);
+	}
+}
+
+void printJson(FILE* f) {
+	fprintf(f, "{\n  \"benchmark\": \"hw3-rasterizer\",\n  \"results\": [\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result& r = results[i];
+		fprintf(f, "    {\"kernel\": \"%s\", \"target\": \"%s\", \"params\": \"%s\", \"primitives\": %lld, \"pixels\": %lld, "
+			"\"mpixels_per_s\": %.3f, \"ns_per_primitive\": %.3f}%s\n",
+			r.kernel.c_str(), r.target.c_str(), r.params.c_str(), r.primitives, r.pixels,
+			r.pixels / r.seconds / 1e6, r.seconds / r.primitives * 1e9, i + 1 < results.size() ? "," : "");
+	}
+	fprintf(f, "  ]\n}\n");
+}
+
+int main(int argc, char** argv) {
+	bool json = false;
+	const char* outPath = NULL;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--json") == 0)
+			json = true;
+		else if (strcmp(argv[i], "--quick") == 0)
+			minSeconds = 0.02;
+		else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+			outPath = argv[++i];
+		else {
+			fprintf(stderr, "usage: %s [--json] [--out file] [--quick]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	const double slopes[] = { 0, 15, 30, 45, 60, 75, 90 };
+	const int lengths[] = { 16, 128, 1000 };
+	for (int l = 0; l < 3; l++)
+		for (int s = 0; s < 7; s++)
+			benchLines(slopes[s], lengths[l]);
+	const int radii[] = { 8, 64, 500 };
+	for (int r = 0; r < 3; r++)
+		benchCircles(radii[r]);
+	benchEightPoint();
+	const int sides[] = { 3, 8, 32 };
+	const int sizes[] = { 16, 64, 256 };
+	for (int s = 0; s < 3; s++)
+		for (int z = 0; z < 3; z++)
+			benchPolygons(sides[s], sizes[z]);
+	for (int z = 0; z < 3; z++)
+		benchTiles(sizes[z]);
+	benchBatch();
+
+	if (json)
+		printJson(stdout);
+	else
+		printTable();
+	if (outPath != NULL) {
+		FILE* f = fopen(outPath, "w");
+		if (f == NULL) {
+			fprintf(stderr, "cannot write %s\n", outPath);
+			return 1;
+		}
+		printJson(f);
+		fclose(f);
+	}
+	return 0;
+}
@@ -0,0 +1,200 @@
+#ifndef AA_LINE_H
+#define AA_LINE_H
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "clip.h"
+#include "point_buffer.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define AA_LINE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AA_LINE_SSE2
+#endif
+
+// Xiaolin Wu anti-aliased lines.
+// Every step along the major axis covers two pixels across the line, (x, y) and (x, y + 1),
+// with coverage 1 - f and f where f is the fractional part of the ideal y. Positions go to a
+// PointBuffer in the same int16 layout as the aliased modes; coverage goes to a parallel byte
+// stream (one byte per vertex, 0..255) that is uploaded as a normalized vertex attribute.
+// The inner loop is branch free, so it is computed 8 steps at a time with AVX2 or 4 with SSE2.
+
+// scalar version of steps [k, kEnd), also used for the tails of the SIMD loops
+inline void wuStepsScalar(short* pos, unsigned char* cov, int steep, int x0, float y0, float gradient, int k, int kEnd) {
+	for (; k < kEnd; k++) {
+		float fy = y0 + gradient * (float)k;
+		int iy = (int)std::floor(fy);
+		int c1 = (int)((fy - (float)iy) * 255.0f + 0.5f);
+		int x = x0 + k;
+		if (steep) {
+			pos[0] = (short)iy;
+			pos[1] = (short)x;
+			pos[2] = (short)(iy + 1);
+			pos[3] = (short)x;
+		}
+		else {
+			pos[0] = (short)x;
+			pos[1] = (short)iy;
+			pos[2] = (short)x;
+			pos[3] = (short)(iy + 1);
+		}
+		cov[0] = (unsigned char)(255 - c1);
+		cov[1] = (unsigned char)c1;
+		pos += 4;
+		cov += 2;
+	}
+}
+
+#if defined(AA_LINE_AVX2)
+inline void wuSteps(short* pos, unsigned char* cov, int steep, int x0, float y0, float gradient, int k, int kEnd) {
+	const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256i low16 = _mm256_set1_epi32(0xFFFF);
+	const __m256i one = _mm256_set1_epi32(1);
+	const __m256i full = _mm256_set1_epi32(255);
+	const __m256 vy0 = _mm256_set1_ps(y0), vg = _mm256_set1_ps(gradient);
+	const __m256 scale = _mm256_set1_ps(255.0f), half = _mm256_set1_ps(0.5f);
+	for (; k + 8 <= kEnd; k += 8) {
+		__m256i kv = _mm256_add_epi32(_mm256_set1_epi32(k), lane);
+		__m256 fy = _mm256_add_ps(vy0, _mm256_mul_ps(vg, _mm256_cvtepi32_ps(kv)));
+		__m256 fl = _mm256_floor_ps(fy);
+		__m256i iy = _mm256_cvttps_epi32(fl);
+		__m256i c1 = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(fy, fl), scale), half));
+		__m256i c0 = _mm256_sub_epi32(full, c1);
+		__m256i x = _mm256_add_epi32(_mm256_set1_epi32(x0), kv);
+		__m256i iy1 = _mm256_add_epi32(iy, one);
+		// one 32-bit word per vertex: low half is the first coordinate
+		__m256i a, b;
+		if (steep) {
+			a = _mm256_or_si256(_mm256_and_si256(iy, low16), _mm256_slli_epi32(x, 16));
+			b = _mm256_or_si256(_mm256_and_si256(iy1, low16), _mm256_slli_epi32(x, 16));
+		}
+		else {
+			a = _mm256_or_si256(_mm256_and_si256(x, low16), _mm256_slli_epi32(iy, 16));
+			b = _mm256_or_si256(_mm256_and_si256(x, low16), _mm256_slli_epi32(iy1, 16));
+		}
+		__m256i lo = _mm256_unpacklo_epi32(a, b);
+		__m256i hi = _mm256_unpackhi_epi32(a, b);
+		_mm256_storeu_si256((__m256i*)pos, _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256((__m256i*)(pos + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+		// coverage bytes c0, c1 per step
+		__m256i w = _mm256_or_si256(c0, _mm256_slli_epi32(c1, 8));
+		w = _mm256_srai_epi32(_mm256_slli_epi32(w, 16), 16);
+		w = _mm256_permute4x64_epi64(_mm256_packs_epi32(w, w), 0x08);
+		_mm_storeu_si128((__m128i*)cov, _mm256_castsi256_si128(w));
+		pos += 32;
+		cov += 16;
+	}
+	wuStepsScalar(pos, cov, steep, x0, y0, gradient, k, kEnd);
+}
+#elif defined(AA_LINE_SSE2)
+inline void wuSteps(short* pos, unsigned char* cov, int steep, int x0, float y0, float gradient, int k, int kEnd) {
+	const __m128i lane = _mm_setr_epi32(0, 1, 2, 3);
+	const __m128i low16 = _mm_set1_epi32(0xFFFF);
+	const __m128i one = _mm_set1_epi32(1);
+	const __m128i full = _mm_set1_epi32(255);
+	const __m128 vy0 = _mm_set1_ps(y0), vg = _mm_set1_ps(gradient);
+	const __m128 scale = _mm_set1_ps(255.0f), half = _mm_set1_ps(0.5f);
+	for (; k + 4 <= kEnd; k += 4) {
+		__m128i kv = _mm_add_epi32(_mm_set1_epi32(k), lane);
+		__m128 fy = _mm_add_ps(vy0, _mm_mul_ps(vg, _mm_cvtepi32_ps(kv)));
+		// floor without SSE4.1: truncate, then step down where truncation went up
+		__m128i iy = _mm_cvttps_epi32(fy);
+		__m128 fl = _mm_cvtepi32_ps(iy);
+		__m128 up = _mm_cmpgt_ps(fl, fy);
+		iy = _mm_add_epi32(iy, _mm_castps_si128(up));
+		fl = _mm_sub_ps(fl, _mm_and_ps(up, _mm_set1_ps(1.0f)));
+		__m128i c1 = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(fy, fl), scale), half));
+		__m128i c0 = _mm_sub_epi32(full, c1);
+		__m128i x = _mm_add_epi32(_mm_set1_epi32(x0), kv);
+		__m128i iy1 = _mm_add_epi32(iy, one);
+		__m128i a, b;
+		if (steep) {
+			a = _mm_or_si128(_mm_and_si128(iy, low16), _mm_slli_epi32(x, 16));
+			b = _mm_or_si128(_mm_and_si128(iy1, low16), _mm_slli_epi32(x, 16));
+		}
+		else {
+			a = _mm_or_si128(_mm_and_si128(x, low16), _mm_slli_epi32(iy, 16));
+			b = _mm_or_si128(_mm_and_si128(x, low16), _mm_slli_epi32(iy1, 16));
+		}
+		_mm_storeu_si128((__m128i*)pos, _mm_unpacklo_epi32(a, b));
+		_mm_storeu_si128((__m128i*)(pos + 8), _mm_unpackhi_epi32(a, b));
+		__m128i w = _mm_or_si128(c0, _mm_slli_epi32(c1, 8));
+		w = _mm_srai_epi32(_mm_slli_epi32(w, 16), 16);
+		_mm_storel_epi64((__m128i*)cov, _mm_packs_epi32(w, w));
+		pos += 16;
+		cov += 8;
+	}
+	wuStepsScalar(pos, cov, steep, x0, y0, gradient, k, kEnd);
+}
+#else
+inline void wuSteps(short* pos, unsigned char* cov, int steep, int x0, float y0, float gradient, int k, int kEnd) {
+	wuStepsScalar(pos, cov, steep, x0, y0, gradient, k, kEnd);
+}
+#endif
+
+// Anti-aliased line from (x1,y1) to (x2,y2). With a clip rectangle only the steps whose
+// pixels can be inside it are generated (the minor axis keeps a one pixel margin), and the two
+// pixels of every step left out are counted in clip->Saved. Without one the line is still
+// limited to the int16 range of the PointBuffer.
+inline void drawLineAA(PointBuffer& points, std::vector<unsigned char>& coverage, int x1, int y1, int x2, int y2, ClipRect* clip = NULL) {
+	// the minor axis bound below is only good to a pixel or two, and iy + 1 is stored as well
+	static const ClipRect storable(COORD_MIN + 2, COORD_MIN + 2, COORD_MAX - 3, COORD_MAX - 3);
+	const ClipRect& bounds = clip != NULL ? *clip : storable;
+	int steep = abs(y2 - y1) > abs(x2 - x1);
+	int temp;
+	if (steep) {
+		temp = x1;
+		x1 = y1;
+		y1 = temp;
+		temp = x2;
+		x2 = y2;
+		y2 = temp;
+	}
+	if (x1 > x2) {
+		temp = x1;
+		x1 = x2;
+		x2 = temp;
+		temp = y1;
+		y1 = y2;
+		y2 = temp;
+	}
+	int dx = x2 - x1, dy = y2 - y1;
+	float gradient = dx == 0 ? 0.0f : (float)dy / (float)dx;
+	int kb = 0, ke = dx;
+	int majorMin = steep ? bounds.YMin : bounds.XMin, majorMax = steep ? bounds.YMax : bounds.XMax;
+	int minorMin = steep ? bounds.XMin : bounds.YMin, minorMax = steep ? bounds.XMax : bounds.YMax;
+	if (majorMin - x1 > kb)
+		kb = majorMin - x1;
+	if (majorMax - x1 < ke)
+		ke = majorMax - x1;
+	// y(k) = y1 + gradient * k has to stay within [minorMin - 1, minorMax]
+	if (dy == 0) {
+		if (y1 < minorMin - 1 || y1 > minorMax)
+			ke = kb - 1;
+	}
+	else {
+		float ka = (minorMin - 1 - y1) / gradient, kc = (minorMax + 1 - y1) / gradient;
+		if (ka > kc) {
+			float t = ka;
+			ka = kc;
+			kc = t;
+		}
+		if (ka > kb)
+			kb = ka > (float)ke ? ke + 1 : (int)std::floor(ka);
+		if (kc < ke)
+			ke = kc < (float)kb ? kb - 1 : (int)std::ceil(kc);
+	}
+	int steps = kb > ke ? 0 : ke - kb + 1;
+	if (clip != NULL)
+		clip->Saved += 2LL * (dx + 1 - steps);
+	if (steps == 0)
+		return;
+	size_t base = coverage.size();
+	coverage.resize(base + 2 * steps);
+	short* pos = points.alloc(4 * steps);
+	wuSteps(pos, &coverage[base], steep, x1, (float)y1, gradient, kb, ke + 1);
+}
+#endif
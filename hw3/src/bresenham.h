@@ -0,0 +1,178 @@
+#ifndef BRESENHAM_H
+#define BRESENHAM_H
+
+#include <cstdlib>
+
+// Bresenham line / midpoint circle kernels, templated on where the pixels go.
+// A Target has to provide
+//   void point(int x, int y);                          one pixel
+//   void span(int x0, int y0, int x1, int y1);  a run of pixels from (x0,y0) to (x1,y1)
+//                                               inclusive, either one row or one column
+// so the same loops can feed the VBO, a per-thread buffer or anything else.
+
+template <typename Target>
+void drawLine(Target& target, int x1, int y1, int x2, int y2) {
+	// жбǷ1ǶǷ45
+	int isKbig = (abs(y2 - y1) > abs(x2 - x1)) ? 1 : 0;
+	int temp;
+	// бʴ1xy
+	if (isKbig) {
+		temp = x1;
+		x1 = y1;
+		y1 = temp;
+		temp = x2;
+		x2 = y2;
+		y2 = temp;
+	}
+	// point1point2
+	if (x1 > x2) {
+		temp = x1;
+		x1 = x2;
+		x2 = temp;
+		temp = y1;
+		y1 = y2;
+		y2 = temp;
+	}
+	int dx = abs(x2 - x1);
+	int dy = abs(y2 - y1);
+	int dy2 = 2 * dy;
+	int dx2 = 2 * dx;
+	int dy2_dx2 = dy2 - dx2;
+	int yi = y1;
+	int p;
+	int addnum = (y1 < y2) ? 1 : -1;
+	p = 2 * dy - dx;
+	// ʹBresenham㷨ЩҪĶ
+	for (int xi = x1; xi <= x2; xi++) {
+		if (isKbig)
+			target.point(yi, xi);
+		else
+			target.point(xi, yi);
+		if (p <= 0) {
+			p += dy2;
+		}
+		else {
+			yi += addnum;
+			p += dy2_dx2;
+		}
+	}
+}
+
+//(x0,y0)ڣ0,0Բ֮ƽƵx,y
+template <typename Target>
+void drawEightPoint(Target& target, int x, int y, int x0, int y0) {
+	target.point(x0 + x, y0 + y);
+	target.point(y0 + x, x0 + y);
+	target.point(-y0 + x, x0 + y);
+	target.point(-x0 + x, y0 + y);
+	target.point(-x0 + x, -y0 + y);
+	target.point(-y0 + x, -x0 + y);
+	target.point(y0 + x, -x0 + y);
+	target.point(x0 + x, -y0 + y);
+}
+
+template <typename Target>
+void drawCircle(Target& target, int x, int y, int r) {
+	int p = 3 - 2 * r;
+	int yi = r;
+	for (int xi = 0; xi < yi; xi++) {
+		drawEightPoint(target, x, y, xi, yi);
+		if (p < 0) {
+			p = p + 2 * xi + 3;
+		}
+		else {
+			p = p + 2 * (xi - yi) + 5;
+			yi--;
+		}
+	}
+}
+
+// УУضΣÿֻ㣬GL_LINES
+template <typename Target>
+void drawLineSpan(Target& target, int x1, int y1, int x2, int y2) {
+	int isKbig = (abs(y2 - y1) > abs(x2 - x1)) ? 1 : 0;
+	int temp;
+	if (isKbig) {
+		temp = x1;
+		x1 = y1;
+		y1 = temp;
+		temp = x2;
+		x2 = y2;
+		y2 = temp;
+	}
+	if (x1 > x2) {
+		temp = x1;
+		x1 = x2;
+		x2 = temp;
+		temp = y1;
+		y1 = y2;
+		y2 = temp;
+	}
+	int dx = abs(x2 - x1);
+	int dy = abs(y2 - y1);
+	int dy2 = 2 * dy;
+	int dy2_dx2 = dy2 - 2 * dx;
+	int yi = y1;
+	int addnum = (y1 < y2) ? 1 : -1;
+	int p = 2 * dy - dx;
+	// run start on the major axis; a run ends whenever the minor axis steps
+	int xs = x1;
+	for (int xi = x1; xi <= x2; xi++) {
+		if (p <= 0) {
+			p += dy2;
+		}
+		else {
+			if (isKbig)
+				target.span(yi, xs, yi, xi);
+			else
+				target.span(xs, yi, xi, yi);
+			xs = xi + 1;
+			yi += addnum;
+			p += dy2_dx2;
+		}
+	}
+	if (xs <= x2) {
+		if (isKbig)
+			target.span(yi, xs, yi, x2);
+		else
+			target.span(xs, yi, x2, yi);
+	}
+}
+
+// run [xs, xe] at height yi of the first octant, mirrored to all eight octants
+template <typename Target>
+void drawEightSpan(Target& target, int x, int y, int xs, int xe, int yi) {
+	// horizontal runs near the top and bottom of the circle
+	target.span(x + xs, y + yi, x + xe, y + yi);
+	target.span(x - xe, y + yi, x - xs, y + yi);
+	target.span(x + xs, y - yi, x + xe, y - yi);
+	target.span(x - xe, y - yi, x - xs, y - yi);
+	// vertical runs near the left and right of the circle
+	target.span(x + yi, y + xs, x + yi, y + xe);
+	target.span(x - yi, y + xs, x - yi, y + xe);
+	target.span(x + yi, y - xe, x + yi, y - xs);
+	target.span(x - yi, y - xe, x - yi, y - xs);
+}
+
+template <typename Target>
+void drawCircleSpan(Target& target, int x, int y, int r) {
+	int p = 3 - 2 * r;
+	int yi = r;
+	int xs = 0;
+	int xi;
+	for (xi = 0; xi < yi; xi++) {
+		if (p < 0) {
+			p = p + 2 * xi + 3;
+		}
+		else {
+			// yi is about to step, so [xs, xi] is a finished run in every octant
+			p = p + 2 * (xi - yi) + 5;
+			drawEightSpan(target, x, y, xs, xi, yi);
+			xs = xi + 1;
+			yi--;
+		}
+	}
+	if (xs < xi)
+		drawEightSpan(target, x, y, xs, xi - 1, yi);
+}
+#endif
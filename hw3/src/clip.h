@@ -0,0 +1,337 @@
+#ifndef CLIP_H
+#define CLIP_H
+
+#include <cstdlib>
+#include "bresenham.h"
+
+// Inclusive pixel rectangle the clipped kernels stay inside, plus a running count of the
+// pixels that were never generated because they fell outside of it.
+struct ClipRect
+{
+	int XMin, YMin, XMax, YMax;
+	long long Saved;
+
+	ClipRect(int width, int height) : XMin(0), YMin(0), XMax(width - 1), YMax(height - 1), Saved(0)
+	{
+	}
+	ClipRect(int xMin, int yMin, int xMax, int yMax) : XMin(xMin), YMin(yMin), XMax(xMax), YMax(yMax), Saved(0)
+	{
+	}
+
+	bool contains(int x, int y) const
+	{
+		return x >= XMin && x <= XMax && y >= YMin && y <= YMax;
+	}
+};
+
+inline long long floorDiv(long long a, long long b)
+{
+	long long q = a / b;
+	if ((a % b != 0) && ((a < 0) != (b < 0)))
+		q--;
+	return q;
+}
+
+inline long long ceilDiv(long long a, long long b)
+{
+	return -floorDiv(-a, b);
+}
+
+// Bresenham line restricted to the clip rectangle, producing exactly the on-screen pixels
+// of drawLine / drawLineSpan. Works like Liang-Barsky on the step index k of the loop:
+// the major axis bounds k directly, and since the number of minor steps taken before step k
+// is m(k) = floor((2dy*k + dx - 1) / (2dx)), the minor axis bounds k in closed form too.
+// The loop then starts at the first visible step with its decision variable reconstructed.
+template <typename Target>
+void drawLineClipped(Target& target, ClipRect& clip, int x1, int y1, int x2, int y2, bool spans) {
+	int isKbig = (abs(y2 - y1) > abs(x2 - x1)) ? 1 : 0;
+	int temp;
+	if (isKbig) {
+		temp = x1;
+		x1 = y1;
+		y1 = temp;
+		temp = x2;
+		x2 = y2;
+		y2 = temp;
+	}
+	if (x1 > x2) {
+		temp = x1;
+		x1 = x2;
+		x2 = temp;
+		temp = y1;
+		y1 = y2;
+		y2 = temp;
+	}
+	int majorMin = isKbig ? clip.YMin : clip.XMin, majorMax = isKbig ? clip.YMax : clip.XMax;
+	int minorMin = isKbig ? clip.XMin : clip.YMin, minorMax = isKbig ? clip.XMax : clip.YMax;
+	long long dx = x2 - x1;
+	long long dy = abs(y2 - y1);
+	int addnum = (y1 < y2) ? 1 : -1;
+	long long total = dx + 1;
+
+	// steps allowed by the major axis
+	long long kb = majorMin - x1 > 0 ? majorMin - x1 : 0;
+	long long ke = majorMax - x1 < dx ? majorMax - x1 : dx;
+	// steps allowed by the minor axis: need lo <= m(k) <= hi
+	long long lo = addnum > 0 ? minorMin - y1 : y1 - minorMax;
+	long long hi = addnum > 0 ? minorMax - y1 : y1 - minorMin;
+	if (dy == 0) {
+		if (lo > 0 || hi < 0)
+			ke = -1;
+	}
+	else {
+		long long k = ceilDiv(2 * dx * lo - dx + 1, 2 * dy);
+		if (k > kb)
+			kb = k;
+		k = floorDiv(2 * dx * (hi + 1) - dx, 2 * dy);
+		if (k < ke)
+			ke = k;
+	}
+	if (kb > ke) {
+		clip.Saved += total;
+		return;
+	}
+	clip.Saved += total - (ke - kb + 1);
+
+	long long m = dx > 0 ? floorDiv(2 * dy * kb + dx - 1, 2 * dx) : 0;
+	int yi = int(y1 + addnum * m);
+	int p = int(2 * dy - dx + 2 * dy * kb - 2 * dx * m);
+	int dy2 = int(2 * dy);
+	int dy2_dx2 = int(2 * dy - 2 * dx);
+	int xb = int(x1 + kb), xe = int(x1 + ke);
+	if (!spans) {
+		for (int xi = xb; xi <= xe; xi++) {
+			if (isKbig)
+				target.point(yi, xi);
+			else
+				target.point(xi, yi);
+			if (p <= 0) {
+				p += dy2;
+			}
+			else {
+				yi += addnum;
+				p += dy2_dx2;
+			}
+		}
+		return;
+	}
+	int xs = xb;
+	for (int xi = xb; xi <= xe; xi++) {
+		if (p <= 0) {
+			p += dy2;
+		}
+		else {
+			if (isKbig)
+				target.span(yi, xs, yi, xi);
+			else
+				target.span(xs, yi, xi, yi);
+			xs = xi + 1;
+			yi += addnum;
+			p += dy2_dx2;
+		}
+	}
+	if (xs <= xe) {
+		if (isKbig)
+			target.span(yi, xs, yi, xe);
+		else
+			target.span(xs, yi, xe, yi);
+	}
+}
+
+// The eight octants in drawEightPoint order: first-octant offset (a, b) goes to
+// (sx * a, sy * b), or to (sx * b, sy * a) when the octant is mirrored about y = x.
+static const int OCTANT_SWAP[8] = { 0, 1, 1, 0, 0, 1, 1, 0 };
+static const int OCTANT_SX[8] = { 1, 1, -1, -1, -1, -1, 1, 1 };
+static const int OCTANT_SY[8] = { 1, 1, 1, 1, -1, -1, -1, -1 };
+
+enum OctantClip { OCTANT_OUT, OCTANT_IN, OCTANT_PARTIAL };
+
+// Classify every octant arc of a circle against the clip rectangle using the arc's bounding
+// box, so whole octants can be skipped (or drawn without tests) instead of testing each pixel.
+inline void classifyOctants(const ClipRect& clip, int x, int y, int r, OctantClip status[8]) {
+	// over the midpoint loop xi runs over [0, ~r/sqrt(2)] and yi over [~r/sqrt(2), r]
+	int aMax = int(r * 0.7072f) + 2;
+	int bMin = int(r * 0.7071f) - 2;
+	if (aMax > r)
+		aMax = r;
+	if (bMin < 0)
+		bMin = 0;
+	for (int o = 0; o < 8; o++) {
+		int lo0 = 0, hi0 = aMax, lo1 = bMin, hi1 = r;
+		if (OCTANT_SWAP[o]) {
+			lo0 = bMin;
+			hi0 = r;
+			lo1 = 0;
+			hi1 = aMax;
+		}
+		int px0 = OCTANT_SX[o] > 0 ? x + lo0 : x - hi0, px1 = OCTANT_SX[o] > 0 ? x + hi0 : x - lo0;
+		int py0 = OCTANT_SY[o] > 0 ? y + lo1 : y - hi1, py1 = OCTANT_SY[o] > 0 ? y + hi1 : y - lo1;
+		if (px1 < clip.XMin || px0 > clip.XMax || py1 < clip.YMin || py0 > clip.YMax)
+			status[o] = OCTANT_OUT;
+		else if (px0 >= clip.XMin && px1 <= clip.XMax && py0 >= clip.YMin && py1 <= clip.YMax)
+			status[o] = OCTANT_IN;
+		else
+			status[o] = OCTANT_PARTIAL;
+	}
+}
+
+// number of iterations of the midpoint circle loop
+inline int circleSteps(int r) {
+	int p = 3 - 2 * r;
+	int yi = r;
+	int xi;
+	for (xi = 0; xi < yi; xi++) {
+		if (p < 0) {
+			p = p + 2 * xi + 3;
+		}
+		else {
+			p = p + 2 * (xi - yi) + 5;
+			yi--;
+		}
+	}
+	return xi;
+}
+
+// clip a row or column run against the rectangle; returns the number of pixels emitted
+template <typename Target>
+int clipSpan(Target& target, const ClipRect& clip, int x0, int y0, int x1, int y1) {
+	if (x0 < clip.XMin)
+		x0 = clip.XMin;
+	if (x1 > clip.XMax)
+		x1 = clip.XMax;
+	if (y0 < clip.YMin)
+		y0 = clip.YMin;
+	if (y1 > clip.YMax)
+		y1 = clip.YMax;
+	if (x0 > x1 || y0 > y1)
+		return 0;
+	target.span(x0, y0, x1, y1);
+	return (x1 - x0) + (y1 - y0) + 1;
+}
+
+// Target adapter clipping every point and span of another target against the rectangle, for
+// the kernels that have no clipped version of their own. The pixels dropped are counted in
+// clip.Saved; they are still generated, but never uploaded or written.
+template <typename Target>
+class ClipTarget
+{
+public:
+	ClipTarget(Target& target, ClipRect& clip) : Inner(target), Clip(clip)
+	{
+	}
+
+	void point(int x, int y)
+	{
+		if (Clip.contains(x, y))
+			Inner.point(x, y);
+		else
+			Clip.Saved++;
+	}
+	void span(int x0, int y0, int x1, int y1)
+	{
+		Clip.Saved += (x1 - x0) + (y1 - y0) + 1 - clipSpan(Inner, Clip, x0, y0, x1, y1);
+	}
+
+private:
+	Target& Inner;
+	ClipRect& Clip;
+
+	ClipTarget(const ClipTarget&);
+	ClipTarget& operator=(const ClipTarget&);
+};
+
+// drawEightSpan with per-octant clipping; returns the number of pixels emitted
+template <typename Target>
+int clipEightSpan(Target& target, const ClipRect& clip, const OctantClip status[8], int x, int y, int xs, int xe, int yi) {
+	int emitted = 0;
+	for (int o = 0; o < 8; o++) {
+		if (status[o] == OCTANT_OUT)
+			continue;
+		int x0, y0, x1, y1;
+		if (OCTANT_SWAP[o]) {
+			// column x + sx * yi
+			x0 = x1 = x + OCTANT_SX[o] * yi;
+			y0 = OCTANT_SY[o] > 0 ? y + xs : y - xe;
+			y1 = OCTANT_SY[o] > 0 ? y + xe : y - xs;
+		}
+		else {
+			// row y + sy * yi
+			y0 = y1 = y + OCTANT_SY[o] * yi;
+			x0 = OCTANT_SX[o] > 0 ? x + xs : x - xe;
+			x1 = OCTANT_SX[o] > 0 ? x + xe : x - xs;
+		}
+		if (status[o] == OCTANT_IN) {
+			target.span(x0, y0, x1, y1);
+			emitted += (x1 - x0) + (y1 - y0) + 1;
+		}
+		else {
+			emitted += clipSpan(target, clip, x0, y0, x1, y1);
+		}
+	}
+	return emitted;
+}
+
+// Midpoint circle restricted to the clip rectangle, producing exactly the on-screen pixels
+// of drawCircle / drawCircleSpan.
+template <typename Target>
+void drawCircleClipped(Target& target, ClipRect& clip, int x, int y, int r, bool spans) {
+	OctantClip status[8];
+	classifyOctants(clip, x, y, r, status);
+	int in = 0, out = 0;
+	for (int o = 0; o < 8; o++) {
+		if (status[o] == OCTANT_IN)
+			in++;
+		else if (status[o] == OCTANT_OUT)
+			out++;
+	}
+	if (in == 8) {
+		if (spans)
+			drawCircleSpan(target, x, y, r);
+		else
+			drawCircle(target, x, y, r);
+		return;
+	}
+	if (out == 8) {
+		clip.Saved += 8LL * circleSteps(r);
+		return;
+	}
+
+	long long total = 0, emitted = 0;
+	int p = 3 - 2 * r;
+	int yi = r;
+	int xs = 0;
+	int xi;
+	for (xi = 0; xi < yi; xi++) {
+		if (!spans) {
+			for (int o = 0; o < 8; o++) {
+				if (status[o] == OCTANT_OUT)
+					continue;
+				int px = OCTANT_SWAP[o] ? x + OCTANT_SX[o] * yi : x + OCTANT_SX[o] * xi;
+				int py = OCTANT_SWAP[o] ? y + OCTANT_SY[o] * xi : y + OCTANT_SY[o] * yi;
+				if (status[o] == OCTANT_PARTIAL && !clip.contains(px, py))
+					continue;
+				target.point(px, py);
+				emitted++;
+			}
+			total += 8;
+		}
+		if (p < 0) {
+			p = p + 2 * xi + 3;
+		}
+		else {
+			p = p + 2 * (xi - yi) + 5;
+			if (spans) {
+				total += 8 * (xi - xs + 1);
+				emitted += clipEightSpan(target, clip, status, x, y, xs, xi, yi);
+				xs = xi + 1;
+			}
+			yi--;
+		}
+	}
+	if (spans && xs < xi) {
+		total += 8 * (xi - xs);
+		emitted += clipEightSpan(target, clip, status, x, y, xs, xi - 1, yi);
+	}
+	clip.Saved += total - emitted;
+}
+#endif
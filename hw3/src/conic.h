@@ -0,0 +1,450 @@
+#ifndef CONIC_H
+#define CONIC_H
+
+#include <cmath>
+#include "bresenham.h"
+#include "clip.h"
+
+// More conics on top of the midpoint circle of bresenham.h: filled discs, ellipse outlines
+// and fills, and circle arcs. The loops only use integer arithmetic, and the shapes are
+// produced through the quadrant / octant symmetry, so one loop iteration yields up to eight
+// pixels or four rows. Filled shapes are emitted as horizontal spans, one per row, so nothing
+// is tested (or written) per pixel.
+
+// Filled disc bounded by drawCircle: every row the outline has pixels in runs between the
+// outermost of them. The rows |dy| = xi come from the octants next to the x axis (one per
+// step), the rows |dy| = yi from the octants next to the y axis (one per value of yi, emitted
+// when yi is about to change). The outline can skip a row where it crosses the diagonal
+// (r = 3 has nothing at |dy| = 2); the disc has no gap there, that row gets the extent of the
+// row just outside it.
+template <typename Target>
+void fillDisc(Target& target, int x, int y, int r) {
+	int p = 3 - 2 * r;
+	int yi = r;
+	int xi;
+	for (xi = 0; xi < yi; xi++) {
+		target.span(x - yi, y + xi, x + yi, y + xi);
+		if (xi > 0)
+			target.span(x - yi, y - xi, x + yi, y - xi);
+		if (p < 0) {
+			p = p + 2 * xi + 3;
+		}
+		else {
+			target.span(x - xi, y + yi, x + xi, y + yi);
+			target.span(x - xi, y - yi, x + xi, y - yi);
+			p = p + 2 * (xi - yi) + 5;
+			yi--;
+		}
+	}
+	// the last value of yi has not been emitted yet; it is a row of its own unless the
+	// rows from the x axis already reached it
+	if (yi >= xi && xi > 0 && yi > 0) {
+		target.span(x - (xi - 1), y + yi, x + (xi - 1), y + yi);
+		target.span(x - (xi - 1), y - yi, x + (xi - 1), y - yi);
+	}
+}
+
+// Quadrant helpers of the ellipse: (px, py) and its mirrors, without emitting the same pixel
+// twice on the axes.
+template <typename Target>
+void drawFourPoint(Target& target, int x, int y, int px, int py) {
+	target.point(x + px, y + py);
+	if (px != 0)
+		target.point(x - px, y + py);
+	if (py != 0) {
+		target.point(x + px, y - py);
+		if (px != 0)
+			target.point(x - px, y - py);
+	}
+}
+
+// row run x + xs .. x + xe at height py, mirrored
+template <typename Target>
+void drawFourRowSpan(Target& target, int x, int y, int xs, int xe, int py) {
+	target.span(x + xs, y + py, x + xe, y + py);
+	if (py != 0)
+		target.span(x + xs, y - py, x + xe, y - py);
+	int ls = xs > 0 ? xs : 1;
+	if (ls <= xe) {
+		target.span(x - xe, y + py, x - ls, y + py);
+		if (py != 0)
+			target.span(x - xe, y - py, x - ls, y - py);
+	}
+}
+
+// column run y + ys .. y + ye at px, mirrored
+template <typename Target>
+void drawFourColumnSpan(Target& target, int x, int y, int ys, int ye, int px) {
+	target.span(x + px, y + ys, x + px, y + ye);
+	if (px != 0)
+		target.span(x - px, y + ys, x - px, y + ye);
+	int ls = ys > 0 ? ys : 1;
+	if (ls <= ye) {
+		target.span(x + px, y - ye, x + px, y - ls);
+		if (px != 0)
+			target.span(x - px, y - ye, x - px, y - ls);
+	}
+}
+
+// An ellipse with a zero semi-axis is the segment along the other one; the midpoint loops
+// below would collapse it to the centre pixel.
+template <typename Target>
+void drawFlatEllipse(Target& target, int x, int y, int rx, int ry, bool spans) {
+	if (spans) {
+		target.span(x - rx, y - ry, x + rx, y + ry);
+		return;
+	}
+	if (ry == 0) {
+		for (int i = -rx; i <= rx; i++)
+			target.point(x + i, y);
+	}
+	else {
+		for (int i = -ry; i <= ry; i++)
+			target.point(x, y + i);
+	}
+}
+
+// Midpoint ellipse with semi-axes rx, ry. Region 1 (|slope| < 1) steps x and sometimes y,
+// region 2 steps y and sometimes x; the decision variables are scaled by 4 so the half-pixel
+// midpoints stay integers. With spans, region 1 gives row runs and region 2 column runs.
+template <typename Target>
+void drawEllipse(Target& target, int x, int y, int rx, int ry, bool spans) {
+	if (rx < 0 || ry < 0)
+		return;
+	if (rx == 0 || ry == 0) {
+		drawFlatEllipse(target, x, y, rx, ry, spans);
+		return;
+	}
+	long long a2 = (long long)rx * rx, b2 = (long long)ry * ry;
+	int px = 0, py = ry;
+	int xs = 0;
+	long long d1 = 4 * b2 - 4 * a2 * ry + a2;
+	while (b2 * px < a2 * py) {
+		if (!spans)
+			drawFourPoint(target, x, y, px, py);
+		if (d1 < 0) {
+			d1 += 4 * b2 * (2 * px + 3);
+		}
+		else {
+			d1 += 4 * b2 * (2 * px + 3) + 4 * a2 * (2 - 2 * py);
+			if (spans)
+				drawFourRowSpan(target, x, y, xs, px, py);
+			xs = px + 1;
+			py--;
+		}
+		px++;
+	}
+	if (spans && xs < px)
+		drawFourRowSpan(target, x, y, xs, px - 1, py);
+
+	long long d2 = b2 * (2 * px + 1) * (2 * px + 1) + 4 * a2 * (py - 1) * (py - 1) - 4 * a2 * b2;
+	int ye = py;
+	while (py >= 0) {
+		if (!spans)
+			drawFourPoint(target, x, y, px, py);
+		if (d2 > 0) {
+			d2 += 4 * a2 * (3 - 2 * py);
+		}
+		else {
+			d2 += 4 * b2 * (2 * px + 2) + 4 * a2 * (3 - 2 * py);
+			if (spans)
+				drawFourColumnSpan(target, x, y, py, ye, px);
+			ye = py - 1;
+			px++;
+		}
+		py--;
+	}
+	if (spans && ye >= 0)
+		drawFourColumnSpan(target, x, y, 0, ye, px);
+}
+
+// Filled ellipse: the same loop as drawEllipse, one row per value of py running between the
+// outermost outline pixels of that row.
+template <typename Target>
+void fillEllipse(Target& target, int x, int y, int rx, int ry) {
+	if (rx < 0 || ry < 0)
+		return;
+	if (rx == 0 || ry == 0) {
+		drawFlatEllipse(target, x, y, rx, ry, true);
+		return;
+	}
+	long long a2 = (long long)rx * rx, b2 = (long long)ry * ry;
+	int px = 0, py = ry;
+	long long d1 = 4 * b2 - 4 * a2 * ry + a2;
+	while (b2 * px < a2 * py) {
+		if (d1 < 0) {
+			d1 += 4 * b2 * (2 * px + 3);
+		}
+		else {
+			d1 += 4 * b2 * (2 * px + 3) + 4 * a2 * (2 - 2 * py);
+			// px is the last pixel of row py; region 2 never comes back to it
+			drawFourRowSpan(target, x, y, 0, px, py);
+			py--;
+		}
+		px++;
+	}
+	long long d2 = b2 * (2 * px + 1) * (2 * px + 1) + 4 * a2 * (py - 1) * (py - 1) - 4 * a2 * b2;
+	while (py >= 0) {
+		// one outline pixel per row here, and it is the outermost one
+		drawFourRowSpan(target, x, y, 0, px, py);
+		if (d2 > 0) {
+			d2 += 4 * a2 * (3 - 2 * py);
+		}
+		else {
+			d2 += 4 * b2 * (2 * px + 2) + 4 * a2 * (3 - 2 * py);
+			px++;
+		}
+		py--;
+	}
+}
+
+// Angle range of an arc, counter-clockwise from start to end in whole degrees. The two
+// boundary directions are turned into integer vectors once; whether a pixel offset is inside
+// is then decided with integer cross products only.
+struct ArcRange
+{
+	int StartDeg, Sweep;
+	long long Sx, Sy, Ex, Ey;
+
+	ArcRange(int startDeg, int endDeg)
+	{
+		StartDeg = ((startDeg % 360) + 360) % 360;
+		Sweep = endDeg - startDeg;
+		if (Sweep < 0 || Sweep > 360)
+			Sweep = ((Sweep % 360) + 360) % 360;
+		const double toRad = 3.14159265358979 / 180.0;
+		Sx = (long long)std::floor(std::cos(StartDeg * toRad) * 16384.0 + 0.5);
+		Sy = (long long)std::floor(std::sin(StartDeg * toRad) * 16384.0 + 0.5);
+		Ex = (long long)std::floor(std::cos((StartDeg + Sweep) * toRad) * 16384.0 + 0.5);
+		Ey = (long long)std::floor(std::sin((StartDeg + Sweep) * toRad) * 16384.0 + 0.5);
+	}
+
+	bool contains(int dx, int dy) const
+	{
+		if (Sweep >= 360)
+			return true;
+		bool afterStart = Sx * dy - Sy * dx >= 0;
+		bool beforeEnd = dx * Ey - dy * Ex >= 0;
+		return Sweep <= 180 ? (afterStart && beforeEnd) : (afterStart || beforeEnd);
+	}
+
+	// how the angles [lo, hi] (degrees, 0 <= lo < hi <= 360) relate to the arc
+	OctantClip classify(int lo, int hi) const
+	{
+		if (Sweep >= 360)
+			return OCTANT_IN;
+		// offsets of lo and hi from the start, going counter-clockwise
+		int a = ((lo - StartDeg) % 360 + 360) % 360;
+		int b = a + (hi - lo);
+		if (b <= Sweep)
+			return OCTANT_IN;
+		if (a > Sweep && b < 360)
+			return OCTANT_OUT;
+		return OCTANT_PARTIAL;
+	}
+};
+
+// angles covered by the octants in drawEightPoint order
+static const int OCTANT_ANGLE_LO[8] = { 45, 0, 135, 90, 225, 180, 315, 270 };
+
+// the steps xs..xe (all at yi) of one octant as a single row or column run
+template <typename Target>
+void drawOctantSpan(Target& target, int o, int x, int y, int xs, int xe, int yi) {
+	if (OCTANT_SWAP[o]) {
+		int cx = x + OCTANT_SX[o] * yi;
+		if (OCTANT_SY[o] > 0)
+			target.span(cx, y + xs, cx, y + xe);
+		else
+			target.span(cx, y - xe, cx, y - xs);
+	}
+	else {
+		int ry = y + OCTANT_SY[o] * yi;
+		if (OCTANT_SX[o] > 0)
+			target.span(x + xs, ry, x + xe, ry);
+		else
+			target.span(x - xe, ry, x - xs, ry);
+	}
+}
+
+// offset of step xi (at yi) of octant o from the centre, as drawEightPoint places it
+inline void octantOffset(int o, int xi, int yi, int& dx, int& dy) {
+	dx = OCTANT_SWAP[o] ? OCTANT_SX[o] * yi : OCTANT_SX[o] * xi;
+	dy = OCTANT_SWAP[o] ? OCTANT_SY[o] * xi : OCTANT_SY[o] * yi;
+}
+
+// how many ends of the arc lie in the angles [lo, lo + 45] of an octant: the most times its
+// pixels can go in or out of the arc
+inline int arcEndsIn(const ArcRange& range, int lo) {
+	int ends = 0;
+	int bounds[2] = { range.StartDeg, (range.StartDeg + range.Sweep) % 360 };
+	for (int i = 0; i < 2; i++) {
+		int d = (bounds[i] - lo + 360) % 360;
+		if (d <= 45)
+			ends++;
+	}
+	return ends;
+}
+
+// the points of step (xi, yi) in the octants of mask (bit o for octant o), as drawEightPoint
+template <typename Target>
+void drawOctantPoints(Target& target, int mask, int x, int y, int xi, int yi) {
+	if (mask & 1)
+		target.point(x + xi, y + yi);
+	if (mask & 2)
+		target.point(x + yi, y + xi);
+	if (mask & 4)
+		target.point(x - yi, y + xi);
+	if (mask & 8)
+		target.point(x - xi, y + yi);
+	if (mask & 16)
+		target.point(x - xi, y - yi);
+	if (mask & 32)
+		target.point(x - yi, y - xi);
+	if (mask & 64)
+		target.point(x + yi, y - xi);
+	if (mask & 128)
+		target.point(x + xi, y - yi);
+}
+
+// the runs xs..xe at yi in the octants of mask, as drawEightSpan
+template <typename Target>
+void drawOctantSpans(Target& target, int mask, int x, int y, int xs, int xe, int yi) {
+	if (mask & 1)
+		target.span(x + xs, y + yi, x + xe, y + yi);
+	if (mask & 2)
+		target.span(x + yi, y + xs, x + yi, y + xe);
+	if (mask & 4)
+		target.span(x - yi, y + xs, x - yi, y + xe);
+	if (mask & 8)
+		target.span(x - xe, y + yi, x - xs, y + yi);
+	if (mask & 16)
+		target.span(x - xe, y - yi, x - xs, y - yi);
+	if (mask & 32)
+		target.span(x - yi, y - xe, x - yi, y - xs);
+	if (mask & 64)
+		target.span(x + yi, y - xe, x + yi, y - xs);
+	if (mask & 128)
+		target.span(x + xs, y - yi, x + xe, y - yi);
+}
+
+// An octant holding an end of the arc. The pixel angle only moves one way along an octant, so
+// whether a step is visible only changes where it passes one of those ends. Visible is the
+// state of the steps reached so far and FlipsLeft the ends not passed yet; at zero the rest of
+// the octant is decided, and it joins the drawn mask or is dropped.
+struct ArcOctant
+{
+	int O;
+	bool Visible;
+	int FlipsLeft;
+};
+
+// Splits the octants of an arc into the mask of those drawn whole and the ones still to be cut
+// at an end (returned, with the visibility of their first step).
+inline int arcOctants(const ArcRange& range, int r, int& drawn, ArcOctant pending[8]) {
+	int count = 0;
+	drawn = 0;
+	for (int o = 0; o < 8; o++) {
+		OctantClip status = range.classify(OCTANT_ANGLE_LO[o], OCTANT_ANGLE_LO[o] + 45);
+		if (status == OCTANT_IN)
+			drawn |= 1 << o;
+		if (status != OCTANT_PARTIAL)
+			continue;
+		int dx, dy;
+		octantOffset(o, 0, r, dx, dy);
+		ArcOctant& a = pending[count++];
+		a.O = o;
+		a.Visible = range.contains(dx, dy);
+		a.FlipsLeft = arcEndsIn(range, OCTANT_ANGLE_LO[o]);
+	}
+	return count;
+}
+
+// Run xs..xe of a pending octant. Only the last step of the run is tested; the run holding an
+// end (or any run while two are ahead) is walked step by step to find where it is cut.
+template <typename Target>
+void drawArcRun(Target& target, const ArcRange& range, ArcOctant& a, int x, int y, int xs, int xe, int yi) {
+	int dx, dy;
+	octantOffset(a.O, xe, yi, dx, dy);
+	if (a.FlipsLeft > 1 || range.contains(dx, dy) != a.Visible) {
+		int from = xs;
+		for (int xi = xs; xi <= xe; xi++) {
+			octantOffset(a.O, xi, yi, dx, dy);
+			if (range.contains(dx, dy) == a.Visible)
+				continue;
+			if (a.Visible)
+				drawOctantSpan(target, a.O, x, y, from, xi - 1, yi);
+			from = xi;
+			a.Visible = !a.Visible;
+			if (--a.FlipsLeft == 0)
+				break;
+		}
+		xs = from;
+	}
+	if (a.Visible)
+		drawOctantSpan(target, a.O, x, y, xs, xe, yi);
+}
+
+// a pending octant that has passed all its ends joins the drawn mask or is dropped
+inline void settleArcOctant(ArcOctant pending[8], int& count, int& i, int& drawn) {
+	if (pending[i].FlipsLeft > 0)
+		return;
+	if (pending[i].Visible)
+		drawn |= 1 << pending[i].O;
+	pending[i--] = pending[--count];
+}
+
+// Circle arc: the octants completely inside the range are drawn like drawCircle /
+// drawCircleSpan, the ones outside are skipped, and the (at most two) octants holding an end
+// of the arc switch between drawing and skipping where they pass it (see ArcOctant), after
+// which they are drawn whole or not at all. With spans the loop is the one of drawCircleSpan.
+template <typename Target>
+void drawArc(Target& target, int x, int y, int r, int startDeg, int endDeg, bool spans) {
+	ArcRange range(startDeg, endDeg);
+	int drawn;
+	ArcOctant pending[8];
+	int count = arcOctants(range, r, drawn, pending);
+
+	int p = 3 - 2 * r;
+	int yi = r;
+	int xs = 0;
+	int xi;
+	for (xi = 0; xi < yi; xi++) {
+		if (!spans) {
+			drawOctantPoints(target, drawn, x, y, xi, yi);
+			for (int i = 0; i < count; i++) {
+				ArcOctant& a = pending[i];
+				int dx, dy;
+				octantOffset(a.O, xi, yi, dx, dy);
+				if (range.contains(dx, dy) != a.Visible) {
+					a.Visible = !a.Visible;
+					a.FlipsLeft--;
+				}
+				if (a.Visible)
+					target.point(x + dx, y + dy);
+				settleArcOctant(pending, count, i, drawn);
+			}
+		}
+		if (p < 0) {
+			p = p + 2 * xi + 3;
+		}
+		else {
+			p = p + 2 * (xi - yi) + 5;
+			if (spans) {
+				drawOctantSpans(target, drawn, x, y, xs, xi, yi);
+				for (int i = 0; i < count; i++) {
+					drawArcRun(target, range, pending[i], x, y, xs, xi, yi);
+					settleArcOctant(pending, count, i, drawn);
+				}
+				xs = xi + 1;
+			}
+			yi--;
+		}
+	}
+	if (spans && xs < xi) {
+		drawOctantSpans(target, drawn, x, y, xs, xi - 1, yi);
+		for (int i = 0; i < count; i++)
+			drawArcRun(target, range, pending[i], x, y, xs, xi - 1, yi);
+	}
+}
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <cstring>
+#include <vector>
+
+// CPU-side RGBA8 image the rasterizer can draw into directly (it is a Target for bresenham.h).
+// Row 0 is the bottom row, so the pixels can go to glTexSubImage2D as they are.
+class Framebuffer
+{
+public:
+	Framebuffer() : Width(0), Height(0), Color(rgba(255, 128, 51))
+	{
+	}
+
+	// pack a color the way GL_RGBA / GL_UNSIGNED_BYTE reads it on a little-endian machine
+	static unsigned int rgba(unsigned char r, unsigned char g, unsigned char b, unsigned char a = 255)
+	{
+		return (unsigned int)r | ((unsigned int)g << 8) | ((unsigned int)b << 16) | ((unsigned int)a << 24);
+	}
+
+	void resize(int width, int height)
+	{
+		Width = width > 0 ? width : 0;
+		Height = height > 0 ? height : 0;
+		Pixels.resize((size_t)Width * Height);
+	}
+	void clear(unsigned int value)
+	{
+		for (size_t i = 0; i < Pixels.size(); i++)
+			Pixels[i] = value;
+	}
+	void setColor(unsigned int value)
+	{
+		Color = value;
+	}
+
+	void point(int x, int y)
+	{
+		if ((unsigned int)x < (unsigned int)Width && (unsigned int)y < (unsigned int)Height)
+			Pixels[(size_t)y * Width + x] = Color;
+	}
+	// inclusive run along one row (y0 == y1) or one column, see bresenham.h
+	void span(int x0, int y0, int x1, int y1)
+	{
+		if (y0 == y1) {
+			if ((unsigned int)y0 >= (unsigned int)Height)
+				return;
+			int xs = clampTo(x0, Width), xe = clampTo(x1 + 1, Width);
+			unsigned int* row = &Pixels[(size_t)y0 * Width];
+			for (int x = xs; x < xe; x++)
+				row[x] = Color;
+		}
+		else {
+			if ((unsigned int)x0 >= (unsigned int)Width)
+				return;
+			int ys = clampTo(y0, Height), ye = clampTo(y1 + 1, Height);
+			for (int y = ys; y < ye; y++)
+				Pixels[(size_t)y * Width + x0] = Color;
+		}
+	}
+
+	const unsigned int* data() const { return Pixels.empty() ? NULL : &Pixels[0]; }
+	// for kernels that write whole rows themselves (no bounds checks)
+	unsigned int* row(int y) { return Pixels.empty() ? NULL : &Pixels[(size_t)y * Width]; }
+	int width() const { return Width; }
+	int height() const { return Height; }
+	size_t bytes() const { return Pixels.size() * sizeof(unsigned int); }
+
+private:
+	std::vector<unsigned int> Pixels;
+	int Width;
+	int Height;
+	unsigned int Color;
+
+	static int clampTo(int v, int size)
+	{
+		return v < 0 ? 0 : (v > size ? size : v);
+	}
+};
+#endif
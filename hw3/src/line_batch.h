@@ -0,0 +1,161 @@
+#ifndef LINE_BATCH_H
+#define LINE_BATCH_H
+
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include "aa_line.h"
+#include "bresenham.h"
+#include "clip.h"
+#include "point_buffer.h"
+#include "thread_pool.h"
+
+struct Segment
+{
+	int x1, y1, x2, y2;
+};
+
+// Rasterizes large sets of segments on a thread pool.
+// The segments are cut into one contiguous chunk per thread, every chunk is rasterized
+// into its own PointBuffer, and the chunks are then copied back to back into the output,
+// so the result is exactly what drawing the segments one by one would give.
+class LineBatch
+{
+public:
+	LineBatch(unsigned int threads = std::thread::hardware_concurrency()) : Pool(threads)
+	{
+	}
+	~LineBatch()
+	{
+		for (size_t i = 0; i < Chunks.size(); i++)
+			delete Chunks[i];
+	}
+
+	unsigned int maxThreads() const
+	{
+		return Pool.size();
+	}
+
+	// rasterize count segments into out (which is cleared first) using up to `threads` threads;
+	// with a clip rectangle only its pixels are produced and clip->Saved counts the rest
+	void drawLines(PointBuffer& out, const Segment* segments, int count, bool spans, unsigned int threads, ClipRect* clip = NULL)
+	{
+		int chunks = prepareChunks(count, threads);
+
+		Pool.run(chunks, [&](int c) {
+			PointBuffer& buffer = *Chunks[c];
+			buffer.clear();
+			PointTarget target(buffer);
+			int begin = int((long long)count * c / chunks);
+			int end = int((long long)count * (c + 1) / chunks);
+			if (clip != NULL) {
+				ClipRect chunkClip = *clip;
+				chunkClip.Saved = 0;
+				for (int i = begin; i < end; i++) {
+					const Segment& s = segments[i];
+					drawLineClipped(target, chunkClip, s.x1, s.y1, s.x2, s.y2, spans);
+				}
+				Saved[c] = chunkClip.Saved;
+				return;
+			}
+			for (int i = begin; i < end; i++) {
+				const Segment& s = segments[i];
+				if (spans)
+					drawLineSpan(target, s.x1, s.y1, s.x2, s.y2);
+				else
+					drawLine(target, s.x1, s.y1, s.x2, s.y2);
+			}
+		});
+
+		if (clip != NULL) {
+			for (int c = 0; c < chunks; c++)
+				clip->Saved += Saved[c];
+		}
+		merge(out, NULL, chunks);
+	}
+
+	// anti-aliased version (see aa_line.h): positions go to out and one coverage byte per
+	// vertex to coverage, both cleared first; clip->Saved counts the pixels left out as above
+	void drawLinesAA(PointBuffer& out, std::vector<unsigned char>& coverage, const Segment* segments, int count, unsigned int threads, ClipRect* clip = NULL)
+	{
+		int chunks = prepareChunks(count, threads);
+		Pool.run(chunks, [&](int c) {
+			PointBuffer& buffer = *Chunks[c];
+			buffer.clear();
+			Coverage[c].clear();
+			int begin = int((long long)count * c / chunks);
+			int end = int((long long)count * (c + 1) / chunks);
+			ClipRect chunkClip = clip != NULL ? *clip : ClipRect(0, 0);
+			chunkClip.Saved = 0;
+			for (int i = begin; i < end; i++) {
+				const Segment& s = segments[i];
+				drawLineAA(buffer, Coverage[c], s.x1, s.y1, s.x2, s.y2, clip != NULL ? &chunkClip : NULL);
+			}
+			Saved[c] = chunkClip.Saved;
+		});
+		if (clip != NULL) {
+			for (int c = 0; c < chunks; c++)
+				clip->Saved += Saved[c];
+		}
+		merge(out, &coverage, chunks);
+	}
+
+	// number of pixels the segments cover, for throughput numbers
+	static long long pixelCount(const Segment* segments, int count)
+	{
+		long long n = 0;
+		for (int i = 0; i < count; i++) {
+			int dx = abs(segments[i].x2 - segments[i].x1);
+			int dy = abs(segments[i].y2 - segments[i].y1);
+			n += (dx > dy ? dx : dy) + 1;
+		}
+		return n;
+	}
+
+private:
+	ThreadPool Pool;
+	std::vector<PointBuffer*> Chunks;
+	std::vector<std::vector<unsigned char> > Coverage;
+	std::vector<size_t> Offsets;
+	std::vector<long long> Saved;
+
+	// number of chunks to cut count segments into, with their buffers allocated
+	int prepareChunks(int count, unsigned int threads)
+	{
+		int chunks = (int)threads;
+		if (chunks < 1)
+			chunks = 1;
+		if (chunks > count)
+			chunks = count > 0 ? count : 1;
+		while ((int)Chunks.size() < chunks)
+			Chunks.push_back(new PointBuffer());
+		if ((int)Coverage.size() < chunks)
+			Coverage.resize(chunks);
+		Offsets.resize(chunks + 1);
+		Saved.assign(chunks, 0);
+		return chunks;
+	}
+
+	// copy the chunks back to back into one contiguous block, in parallel;
+	// coverage has one byte per vertex, i.e. per two shorts of position
+	void merge(PointBuffer& out, std::vector<unsigned char>* coverage, int chunks)
+	{
+		Offsets[0] = 0;
+		for (int c = 0; c < chunks; c++)
+			Offsets[c + 1] = Offsets[c] + Chunks[c]->size();
+		out.clear();
+		short* dst = out.alloc(Offsets[chunks]);
+		if (coverage != NULL)
+			coverage->resize(Offsets[chunks] / 2);
+		Pool.run(chunks, [&](int c) {
+			if (Chunks[c]->size() > 0)
+				memcpy(dst + Offsets[c], Chunks[c]->data(), Chunks[c]->bytes());
+			if (coverage != NULL && !Coverage[c].empty())
+				memcpy(&(*coverage)[Offsets[c] / 2], &Coverage[c][0], Coverage[c].size());
+		});
+	}
+
+	LineBatch(const LineBatch&);
+	LineBatch& operator=(const LineBatch&);
+};
+#endif
@@ -3,14 +3,31 @@
 #include <imgui.h>
 #include <imgui_impl_glfw_gl3.h>
 #include <iostream>
+#include <vector>
+#include <cstdlib>
+#include "point_buffer.h"
+#include "bresenham.h"
+#include "line_batch.h"
+#include "framebuffer.h"
+#include "clip.h"
+#include "aa_line.h"
+#include "polygon_fill.h"
+#include "tile_raster.h"
+#include "slot_layout.h"
+#include "conic.h"
+#include "thick_lines.h"
 using namespace std;
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow *window);
-void drawLine(int x1, int y1, int x2, int y2);
-void drawCircle(int x, int y, int radius);
-void drawEightPoint(int x, int y, int xi, int yi);
-void setPoint(int x, int y);
+int createProgram(const char* vertexSource, const char* fragmentSource);
+void uploadVertices();
+void uploadArrayBuffer(unsigned int buffer, size_t& capacity, const void* data, size_t bytes);
+void uploadFramebuffer();
+void updateLive(int pointT[3][2], int pointC[1][2], int radius);
+void randomSegments(vector<Segment>& segments, int count, int maxLength);
+void randomPolygons(vector<int>& points, int count, int sides, int size);
+void randomTriangles(vector<Triangle>& triangles, int count, int size);
 
 // settings
 const unsigned int SCR_WIDTH = 800;
@@ -19,21 +36,261 @@ const unsigned int SCR_HEIGHT = 600;
 unsigned int view_width = SCR_WIDTH;
 unsigned int view_height = SCR_HEIGHT;
 
+// aPos is in pixels; pixelOffset is 0.5 for spans so GL_LINES run through pixel centers.
+// aCoverage is the anti-aliasing coverage of the pixel (constant 1 for aliased drawing)
 const char *vertexShaderSource = "#version 330 core\n"
 "layout (location = 0) in vec2 aPos;\n"
+"layout (location = 1) in float aCoverage;\n"
+"uniform vec2 viewport;\n"
+"uniform float pixelOffset;\n"
+"out float coverage;\n"
 "void main()\n"
 "{\n"
-"   gl_Position = vec4(aPos.x, aPos.y, 0.0, 1.0);\n"
+"   vec2 ndc = (aPos + pixelOffset) / (viewport * 0.5) - 1.0;\n"
+"   gl_Position = vec4(ndc.x, ndc.y, 0.0, 1.0);\n"
+"   coverage = aCoverage;\n"
 "}\0";
 const char *fragmentShaderSource = "#version 330 core\n"
+"in float coverage;\n"
 "out vec4 FragColor;\n"
 "void main()\n"
 "{\n"
-"   FragColor = vec4(1.0f, 0.5f, 0.2f, 1.0f);\n"
+"   FragColor = vec4(1.0f, 0.5f, 0.2f, coverage);\n"
 "}\n\0";
+// GPU mode: no vertex data at all, every vertex is one pixel of the shape computed from
+// gl_VertexID and a few uniforms, with the same integer arithmetic as bresenham.h
+const char *gpuVertexShaderSource = "#version 330 core\n"
+"uniform vec2 viewport;\n"
+"uniform int shape;\n"          // 0: the three edges of the triangle, 1: the circle
+"uniform ivec4 edges[3];\n"     // x1, y1, x2, y2
+"uniform ivec3 edgeEnd;\n"      // first vertex after edge 0, 1 and 2
+"uniform ivec3 circle;\n"       // center x, y and radius
+"out float coverage;\n"
+// pixel k of drawLine: step k on the major axis has taken floor((2dy*k + dx - 1) / (2dx)) minor steps
+"ivec2 linePixel(ivec4 e, int k)\n"
+"{\n"
+"   ivec2 a = e.xy, b = e.zw;\n"
+"   bool steep = abs(b.y - a.y) > abs(b.x - a.x);\n"
+"   if (steep) { a = a.yx; b = b.yx; }\n"
+"   if (a.x > b.x) { ivec2 t = a; a = b; b = t; }\n"
+"   int dx = b.x - a.x, dy = abs(b.y - a.y);\n"
+"   int m = dx > 0 ? (2 * dy * k + dx - 1) / (2 * dx) : 0;\n"
+"   ivec2 p = ivec2(a.x + k, a.y < b.y ? a.y + m : a.y - m);\n"
+"   return steep ? p.yx : p;\n"
+"}\n"
+// vertex 8 * step + octant of drawCircle: replay the midpoint loop up to this step
+"ivec2 circlePixel(int v)\n"
+"{\n"
+"   int step = v / 8, octant = v % 8;\n"
+"   int p = 3 - 2 * circle.z, yi = circle.z;\n"
+"   for (int xi = 0; xi < step; xi++) {\n"
+"      if (p < 0) p = p + 2 * xi + 3;\n"
+"      else { p = p + 2 * (xi - yi) + 5; yi--; }\n"
+"   }\n"
+"   ivec2 d = (octant == 1 || octant == 2 || octant == 5 || octant == 6) ? ivec2(yi, step) : ivec2(step, yi);\n"
+"   if (octant >= 2 && octant <= 5) d.x = -d.x;\n"
+"   if (octant >= 4) d.y = -d.y;\n"
+"   return circle.xy + d;\n"
+"}\n"
+"void main()\n"
+"{\n"
+"   int v = gl_VertexID;\n"
+"   ivec2 pixel;\n"
+"   if (shape == 1) pixel = circlePixel(v);\n"
+"   else if (v < edgeEnd.x) pixel = linePixel(edges[0], v);\n"
+"   else if (v < edgeEnd.y) pixel = linePixel(edges[1], v - edgeEnd.x);\n"
+"   else pixel = linePixel(edges[2], v - edgeEnd.y);\n"
+"   vec2 ndc = vec2(pixel) / (viewport * 0.5) - 1.0;\n"
+"   gl_Position = vec4(ndc.x, ndc.y, 0.0, 1.0);\n"
+"   coverage = 1.0;\n"
+"}\0";
+// fullscreen quad for the CPU framebuffer, generated from gl_VertexID
+const char *quadVertexShaderSource = "#version 330 core\n"
+"out vec2 TexCoord;\n"
+"void main()\n"
+"{\n"
+"   vec2 pos = vec2(gl_VertexID & 1, gl_VertexID >> 1);\n"
+"   TexCoord = pos;\n"
+"   gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);\n"
+"}\0";
+const char *quadFragmentShaderSource = "#version 330 core\n"
+"in vec2 TexCoord;\n"
+"out vec4 FragColor;\n"
+"uniform sampler2D screen;\n"
+"void main()\n"
+"{\n"
+"   FragColor = texture(screen, TexCoord);\n"
+"}\n\0";
+
+PointBuffer vertices;
+unsigned int VBO = 0;
+// bytes currently allocated for the VBO; grows geometrically, never shrinks
+size_t vboCapacity = 0;
+
+// anti-aliased mode: Wu lines with one coverage byte per vertex in a second VBO
+bool isAAMode = false;
+vector<unsigned char> coverage;
+unsigned int coverageVBO = 0;
+size_t coverageCapacity = 0;
+bool hasCoverage = false;
+
+// GPU mode: the triangle or circle is generated by gpuVertexShaderSource from the slider
+// values every frame; gpuShape is what is shown (GPU_NONE when the vertex buffer is)
+bool isGpuMode = false;
+enum { GPU_NONE = -1, GPU_TRIANGLE = 0, GPU_CIRCLE = 1 };
+int gpuShape = GPU_NONE;
+
+// live mode: the triangle edges and the circle follow the sliders every frame. Each one has
+// its own range of liveVBO and only the ones whose parameters changed are re-rasterized and
+// re-uploaded with glBufferSubData
+enum { LIVE_EDGE0, LIVE_EDGE1, LIVE_EDGE2, LIVE_CIRCLE, LIVE_SLOTS };
+bool isLiveMode = false;
+SlotLayout liveLayout(LIVE_SLOTS);
+PointBuffer liveSlots[LIVE_SLOTS];
+// per slot: the primitive's own parameters, then the output mode and window size (4..7), then
+// for the circle slot the conic shape and its extra parameters (8..11)
+int liveParams[LIVE_SLOTS][12];
+unsigned int liveVBO = 0;
+int liveUpdated = 0;
+size_t liveBytes = 0;
+
+// thick mode: the triangle outline and the batch of lines become wide quads drawn by
+// ThickLines in one instanced call, instead of relying on glLineWidth
+bool isThickMode = false;
+bool showThick = false;
+float thickWidth = 9.0f;
+int thickJoin = ThickLines::JOIN_MITER;
+vector<float> thickSegments;
+
+// what "Draw circle!" draws
+enum { CONIC_CIRCLE, CONIC_DISC, CONIC_ELLIPSE, CONIC_FILLED_ELLIPSE, CONIC_ARC };
+int conicShape = CONIC_CIRCLE;
+int radiusY = 100;
+int arcStart = 0, arcEnd = 270;
+
+// fill mode: the triangle is filled by the scanline engine instead of outlined
+bool isFillMode = false;
+int fillRule = FILL_EVEN_ODD;
+ScanlineFill filler;
+
+// span mode: every run of pixels on the same row (or column) is one line segment
+bool isSpanMode = false;
+GLenum drawMode = GL_POINTS;
+
+// framebuffer mode: rasterize into a CPU image and show it as one texture
+bool isFramebufferMode = false;
+bool showFramebuffer = false;
+Framebuffer framebuffer;
+unsigned int fbTexture = 0;
+unsigned int fbPBO[2] = { 0, 0 };
+int fbPBOIndex = 0;
+int fbTexWidth = 0, fbTexHeight = 0;
+
+// clip mode: drop off-screen pixels before the Bresenham loops generate them
+bool isClipMode = true;
+long long clippedPixels = 0;
+
+template <typename Target>
+void drawTriangle(Target& target, int p[3][2], bool spans, ClipRect* clip) {
+	if (clip != NULL) {
+		drawLineClipped(target, *clip, p[0][0], p[0][1], p[1][0], p[1][1], spans);
+		drawLineClipped(target, *clip, p[1][0], p[1][1], p[2][0], p[2][1], spans);
+		drawLineClipped(target, *clip, p[0][0], p[0][1], p[2][0], p[2][1], spans);
+	}
+	else if (spans) {
+		drawLineSpan(target, p[0][0], p[0][1], p[1][0], p[1][1]);
+		drawLineSpan(target, p[1][0], p[1][1], p[2][0], p[2][1]);
+		drawLineSpan(target, p[0][0], p[0][1], p[2][0], p[2][1]);
+	}
+	else {
+		drawLine(target, p[0][0], p[0][1], p[1][0], p[1][1]);
+		drawLine(target, p[1][0], p[1][1], p[2][0], p[2][1]);
+		drawLine(target, p[0][0], p[0][1], p[2][0], p[2][1]);
+	}
+}
+
+// anti-aliased triangle outline into vertices / coverage
+void drawTriangleAA(int p[3][2], ClipRect* clip) {
+	drawLineAA(vertices, coverage, p[0][0], p[0][1], p[1][0], p[1][1], clip);
+	drawLineAA(vertices, coverage, p[1][0], p[1][1], p[2][0], p[2][1], clip);
+	drawLineAA(vertices, coverage, p[0][0], p[0][1], p[2][0], p[2][1], clip);
+}
+
+template <typename Target>
+void drawRing(Target& target, int x, int y, int r, bool spans, ClipRect* clip) {
+	if (clip != NULL)
+		drawCircleClipped(target, *clip, x, y, r, spans);
+	else if (spans)
+		drawCircleSpan(target, x, y, r);
+	else
+		drawCircle(target, x, y, r);
+}
+
+// filled with the current fill rule, or outlined like drawTriangle
+template <typename Target>
+void drawPolygon(Target& target, const int* xy, int count, bool fill, bool spans, ClipRect* clip) {
+	if (fill) {
+		filler.fillPolygon(target, xy, count, FillRule(fillRule), clip);
+		return;
+	}
+	for (int i = 0; i < count; i++) {
+		const int* a = xy + 2 * i;
+		const int* b = xy + 2 * ((i + 1) % count);
+		if (clip != NULL)
+			drawLineClipped(target, *clip, a[0], a[1], b[0], b[1], spans);
+		else if (spans)
+			drawLineSpan(target, a[0], a[1], b[0], b[1]);
+		else
+			drawLine(target, a[0], a[1], b[0], b[1]);
+	}
+}
+
+// the disc, ellipse and arc of the circle section
+template <typename Target>
+void drawConicShape(Target& target, int x, int y, int r, bool spans) {
+	switch (conicShape) {
+	case CONIC_DISC:
+		fillDisc(target, x, y, r);
+		break;
+	case CONIC_ELLIPSE:
+		drawEllipse(target, x, y, r, radiusY, spans);
+		break;
+	case CONIC_FILLED_ELLIPSE:
+		fillEllipse(target, x, y, r, radiusY);
+		break;
+	case CONIC_ARC:
+		drawArc(target, x, y, r, arcStart, arcEnd, spans);
+		break;
+	}
+}
 
-float vertices[10000];
-int pointCount = 362;
+// the filled shapes are made of spans only, whatever the output mode
+bool isFilledConic() {
+	return conicShape == CONIC_DISC || conicShape == CONIC_FILLED_ELLIPSE;
+}
+
+// the shape picked in the circle section; the circle outline has its own clipped kernel, the
+// other shapes are clipped span by span, and not at all when their bounding box is on screen
+template <typename Target>
+void drawConic(Target& target, int x, int y, int r, bool spans, ClipRect* clip) {
+	if (conicShape == CONIC_CIRCLE) {
+		drawRing(target, x, y, r, spans, clip);
+		return;
+	}
+	int ry = (conicShape == CONIC_ELLIPSE || conicShape == CONIC_FILLED_ELLIPSE) ? radiusY : r;
+	if (clip == NULL || (clip->contains(x - r, y - ry) && clip->contains(x + r, y + ry))) {
+		drawConicShape(target, x, y, r, spans);
+		return;
+	}
+	ClipTarget<Target> clipped(target, *clip);
+	drawConicShape(clipped, x, y, r, spans);
+}
+
+// CPU֡岢ʹһ
+void beginFramebuffer() {
+	framebuffer.resize(view_width, view_height);
+	framebuffer.clear(Framebuffer::rgba(255, 255, 255));
+}
 
 int main()
 {
@@ -76,60 +333,86 @@ int main()
 
 
 	// build and compile our shader program
-	// vertex shader
-	int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-	glCompileShader(vertexShader);
-	// check for shader compile errors
-	int success;
-	char infoLog[512];
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-	}
-	// fragment shader
-	int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-	glCompileShader(fragmentShader);
-	// check for shader compile errors
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-	}
-	// link shaders
-	int shaderProgram = glCreateProgram();
-	glAttachShader(shaderProgram, vertexShader);
-	glAttachShader(shaderProgram, fragmentShader);
-	glLinkProgram(shaderProgram);
-	// check for linking errors
-	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-	if (!success) {
-		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-	}
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
+	int shaderProgram = createProgram(vertexShaderSource, fragmentShaderSource);
+	int quadProgram = createProgram(quadVertexShaderSource, quadFragmentShaderSource);
+	int gpuProgram = createProgram(gpuVertexShaderSource, fragmentShaderSource);
 
 	// set up vertex data (and buffer(s)) and configure vertex attributes
 	
 
-	unsigned int VBO, VAO;
+	unsigned int VAO;
 	glGenVertexArrays(1, &VAO);
 	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &coverageVBO);
 	// bind the Vertex Array Object first, then bind and set vertex buffer(s), and then configure vertex attributes(s).
 	glBindVertexArray(VAO);
 
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
 	//glBufferData(GL_ARRAY_BUFFER, sizeof(float)*2*pointCount, vertices, GL_DYNAMIC_DRAW);
 
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+	glVertexAttribPointer(0, 2, GL_SHORT, GL_FALSE, 2 * sizeof(short), (void*)0);
 	glEnableVertexAttribArray(0);
+	// coverage bytes 0..255 arrive in the shader as 0..1
+	glBindBuffer(GL_ARRAY_BUFFER, coverageVBO);
+	glVertexAttribPointer(1, 1, GL_UNSIGNED_BYTE, GL_TRUE, 1, (void*)0);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	// live mode has its own buffer, laid out by liveLayout
+	unsigned int liveVAO;
+	glGenVertexArrays(1, &liveVAO);
+	glGenBuffers(1, &liveVBO);
+	glBindVertexArray(liveVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, liveVBO);
+	glVertexAttribPointer(0, 2, GL_SHORT, GL_FALSE, 2 * sizeof(short), (void*)0);
+	glEnableVertexAttribArray(0);
+	memset(liveParams, 0xff, sizeof(liveParams));
 
 	glUseProgram(shaderProgram);
+	int viewportLoc = glGetUniformLocation(shaderProgram, "viewport");
+	int pixelOffsetLoc = glGetUniformLocation(shaderProgram, "pixelOffset");
+
+	// texture + two pixel unpack buffers for the CPU framebuffer; the quad needs no vertex data,
+	// but core profile still wants a VAO bound
+	unsigned int quadVAO;
+	glGenVertexArrays(1, &quadVAO);
+	glGenTextures(1, &fbTexture);
+	glBindTexture(GL_TEXTURE_2D, fbTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glGenBuffers(2, fbPBO);
+	glUseProgram(quadProgram);
+	glUniform1i(glGetUniformLocation(quadProgram, "screen"), 0);
+	int gpuViewportLoc = glGetUniformLocation(gpuProgram, "viewport");
+	int gpuShapeLoc = glGetUniformLocation(gpuProgram, "shape");
+	int gpuEdgesLoc = glGetUniformLocation(gpuProgram, "edges");
+	int gpuEdgeEndLoc = glGetUniformLocation(gpuProgram, "edgeEnd");
+	int gpuCircleLoc = glGetUniformLocation(gpuProgram, "circle");
+
+	ThickLines thick;
+	const float thickColor[4] = { 1.0f, 0.5f, 0.2f, 1.0f };
+
+	LineBatch batch;
+	vector<Segment> segments;
+	int batchCount = 100000;
+	int batchLength = 50;
+	int batchThreads = batch.maxThreads();
+	float batchMs = 0.0f;
+	double batchMpixels = 0.0;
+
+	vector<int> polygons;
+	int polygonCount = 2000;
+	int polygonSides = 6;
+	int polygonSize = 60;
+	float polygonMs = 0.0f;
+
+	TileRasterizer tiles;
+	vector<Triangle> triangles;
+	int triangleCount = 20000;
+	int triangleSize = 60;
+	int tileThreads = tiles.maxThreads();
+	float tileMs = 0.0f;
 
 	int pointT[3][2] = { 0, 0, 0, 0, 0, 0 };
 	int pointC[1][2] = { 0, 0 };
@@ -147,14 +430,85 @@ int main()
 		glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT);
 
-		// draw our first triangle
-		glUseProgram(shaderProgram);
-		glBindVertexArray(VAO);
-		
-
-		// draw points
-		glPointSize(2.0f);
-		glDrawArrays(GL_POINTS, 0, pointCount);
+		if (isLiveMode) {
+			updateLive(pointT, pointC, radius);
+			glUseProgram(shaderProgram);
+			glBindVertexArray(liveVAO);
+			glUniform2f(viewportLoc, float(view_width), float(view_height));
+			glUniform1f(pixelOffsetLoc, isSpanMode ? 0.5f : 0.0f);
+			glVertexAttrib1f(1, 1.0f);
+			glDisable(GL_BLEND);
+			glPointSize(2.0f);
+			glMultiDrawArrays(isSpanMode ? GL_LINES : GL_POINTS, liveLayout.firsts(), liveLayout.counts(), LIVE_CIRCLE);
+			// filled shapes are spans even outside span mode
+			bool circleSpans = isSpanMode || isFilledConic();
+			glUniform1f(pixelOffsetLoc, circleSpans ? 0.5f : 0.0f);
+			glDrawArrays(circleSpans ? GL_LINES : GL_POINTS, liveLayout.first(LIVE_CIRCLE), liveLayout.count(LIVE_CIRCLE));
+		}
+		else if (gpuShape != GPU_NONE) {
+			// only a few uniforms change per frame, so the shape follows the sliders live;
+			// the quad VAO has no attributes, which is all this needs
+			glUseProgram(gpuProgram);
+			glBindVertexArray(quadVAO);
+			glDisable(GL_BLEND);
+			glPointSize(2.0f);
+			glUniform2f(gpuViewportLoc, float(view_width), float(view_height));
+			glUniform1i(gpuShapeLoc, gpuShape);
+			int count;
+			if (gpuShape == GPU_TRIANGLE) {
+				Segment edges[3] = {
+					{ pointT[0][0], pointT[0][1], pointT[1][0], pointT[1][1] },
+					{ pointT[1][0], pointT[1][1], pointT[2][0], pointT[2][1] },
+					{ pointT[0][0], pointT[0][1], pointT[2][0], pointT[2][1] },
+				};
+				int end0 = int(LineBatch::pixelCount(edges, 1));
+				int end1 = end0 + int(LineBatch::pixelCount(edges + 1, 1));
+				count = end1 + int(LineBatch::pixelCount(edges + 2, 1));
+				glUniform4iv(gpuEdgesLoc, 3, &edges[0].x1);
+				glUniform3i(gpuEdgeEndLoc, end0, end1, count);
+			}
+			else {
+				glUniform3i(gpuCircleLoc, pointC[0][0], pointC[0][1], radius);
+				count = 8 * circleSteps(radius);
+			}
+			glDrawArrays(GL_POINTS, 0, count);
+		}
+		else if (showThick) {
+			// pixel coordinates (through the pixel centers) -> NDC
+			thick.setTransform(2.0f / view_width, 2.0f / view_height, 1.0f / view_width - 1.0f, 1.0f / view_height - 1.0f);
+			thick.draw(thickWidth, ThickLines::Join(thickJoin), thickColor);
+		}
+		else if (showFramebuffer) {
+			// one textured quad instead of one vertex per pixel
+			glUseProgram(quadProgram);
+			glBindVertexArray(quadVAO);
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, fbTexture);
+			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+		}
+		else {
+			// draw our first triangle
+			glUseProgram(shaderProgram);
+			glBindVertexArray(VAO);
+			// pixel -> NDC happens in the shader, so a resize needs no re-rasterization
+			glUniform2f(viewportLoc, float(view_width), float(view_height));
+			glUniform1f(pixelOffsetLoc, drawMode == GL_LINES ? 0.5f : 0.0f);
+
+			if (hasCoverage) {
+				// every AA vertex is exactly one pixel, blended by its coverage
+				glEnableVertexAttribArray(1);
+				glEnable(GL_BLEND);
+				glPointSize(1.0f);
+			}
+			else {
+				glDisableVertexAttribArray(1);
+				glVertexAttrib1f(1, 1.0f);
+				glDisable(GL_BLEND);
+				glPointSize(2.0f);
+			}
+			// draw points (or spans)
+			glDrawArrays(drawMode, 0, vertices.vertexCount());
+		}
 
 		//Gui
 		ImGui_ImplGlfwGL3_NewFrame();
@@ -170,11 +524,50 @@ int main()
 		ImGui::SliderInt("width3", &pointT[2][0], 0, view_width);
 		ImGui::SliderInt("height3", &pointT[2][1], 0, view_height);
 		if (ImGui::Button("Draw trangle!")) {
-			pointCount = 0;
-			drawLine(pointT[0][0], pointT[0][1], pointT[1][0], pointT[1][1]);
-			drawLine(pointT[1][0], pointT[1][1], pointT[2][0], pointT[2][1]);
-			drawLine(pointT[0][0], pointT[0][1], pointT[2][0], pointT[2][1]);
-			glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 2 * pointCount, vertices, GL_STATIC_DRAW);
+			ClipRect clip(view_width, view_height);
+			if (isGpuMode) {
+				gpuShape = GPU_TRIANGLE;
+			}
+			else if (isThickMode && !isFillMode) {
+				float xy[6];
+				for (int i = 0; i < 6; i++)
+					xy[i] = float(pointT[i / 2][i % 2]);
+				thick.setStrip(xy, 3, true);
+				showThick = true;
+				gpuShape = GPU_NONE;
+			}
+			else if (isFramebufferMode) {
+				beginFramebuffer();
+				if (isFillMode)
+					filler.fillPolygon(framebuffer, &pointT[0][0], 3, FillRule(fillRule), isClipMode ? &clip : NULL);
+				else
+					drawTriangle(framebuffer, pointT, isSpanMode, isClipMode ? &clip : NULL);
+				uploadFramebuffer();
+			}
+			else if (isFillMode) {
+				vertices.clear();
+				coverage.clear();
+				PointTarget target(vertices);
+				filler.fillPolygon(target, &pointT[0][0], 3, FillRule(fillRule), isClipMode ? &clip : NULL);
+				drawMode = GL_LINES;
+				uploadVertices();
+			}
+			else if (isAAMode) {
+				vertices.clear();
+				coverage.clear();
+				drawTriangleAA(pointT, isClipMode ? &clip : NULL);
+				drawMode = GL_POINTS;
+				uploadVertices();
+			}
+			else {
+				vertices.clear();
+				coverage.clear();
+				PointTarget target(vertices);
+				drawTriangle(target, pointT, isSpanMode, isClipMode ? &clip : NULL);
+				drawMode = isSpanMode ? GL_LINES : GL_POINTS;
+				uploadVertices();
+			}
+			clippedPixels = clip.Saved;
 		}
 
 		ImGui::Text("\nParameter of circle");
@@ -182,11 +575,181 @@ int main()
 		ImGui::SliderInt("width", &pointC[0][0], 0, view_height);
 		ImGui::SliderInt("height", &pointC[0][1], 0, view_width);
 		ImGui::SliderInt("radius", &radius, 0, 800);
+		ImGui::RadioButton("circle", &conicShape, CONIC_CIRCLE);
+		ImGui::SameLine();
+		ImGui::RadioButton("disc", &conicShape, CONIC_DISC);
+		ImGui::SameLine();
+		ImGui::RadioButton("ellipse", &conicShape, CONIC_ELLIPSE);
+		ImGui::SameLine();
+		ImGui::RadioButton("filled ellipse", &conicShape, CONIC_FILLED_ELLIPSE);
+		ImGui::SameLine();
+		ImGui::RadioButton("arc", &conicShape, CONIC_ARC);
+		if (conicShape == CONIC_ELLIPSE || conicShape == CONIC_FILLED_ELLIPSE)
+			ImGui::SliderInt("radius y", &radiusY, 0, 800);
+		if (conicShape == CONIC_ARC) {
+			ImGui::SliderInt("start angle", &arcStart, 0, 360);
+			ImGui::SliderInt("end angle", &arcEnd, 0, 360);
+		}
 		if (ImGui::Button("Draw circle!")) {
-			pointCount = 0;
-			drawCircle(pointC[0][0], pointC[0][1], radius);
-			glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 2 * pointCount, vertices, GL_STATIC_DRAW);
+			ClipRect clip(view_width, view_height);
+			if (isGpuMode) {
+				gpuShape = GPU_CIRCLE;
+			}
+			else if (isFramebufferMode) {
+				beginFramebuffer();
+				drawConic(framebuffer, pointC[0][0], pointC[0][1], radius, isSpanMode, isClipMode ? &clip : NULL);
+				uploadFramebuffer();
+			}
+			else {
+				vertices.clear();
+				coverage.clear();
+				PointTarget target(vertices);
+				drawConic(target, pointC[0][0], pointC[0][1], radius, isSpanMode, isClipMode ? &clip : NULL);
+				// filled shapes are always spans
+				drawMode = (isSpanMode || isFilledConic()) ? GL_LINES : GL_POINTS;
+				uploadVertices();
+			}
+			clippedPixels = clip.Saved;
 		}
+
+		ImGui::Text("\nOutput mode:");
+		ImGui::Checkbox("Span mode", &isSpanMode);
+		ImGui::Checkbox("CPU framebuffer", &isFramebufferMode);
+		ImGui::Checkbox("Clip to window", &isClipMode);
+		ImGui::Checkbox("Anti-aliased lines", &isAAMode);
+		ImGui::Checkbox("GPU-generated (no vertex upload)", &isGpuMode);
+		ImGui::Checkbox("Live (triangle and circle follow the sliders)", &isLiveMode);
+		ImGui::Checkbox("Thick lines (instanced quads)", &isThickMode);
+		if (isThickMode) {
+			ImGui::SliderFloat("line width", &thickWidth, 1.0f, 40.0f);
+			ImGui::RadioButton("miter joins", &thickJoin, ThickLines::JOIN_MITER);
+			ImGui::SameLine();
+			ImGui::RadioButton("round joins", &thickJoin, ThickLines::JOIN_ROUND);
+		}
+		ImGui::Checkbox("Fill polygons", &isFillMode);
+		ImGui::RadioButton("even-odd", &fillRule, FILL_EVEN_ODD);
+		ImGui::SameLine();
+		ImGui::RadioButton("non-zero", &fillRule, FILL_NON_ZERO);
+		ImGui::Text("pixels clipped away: %lld", clippedPixels);
+		if (isLiveMode)
+			ImGui::Text("live: %d of %d primitives re-rasterized, %d bytes uploaded this frame", liveUpdated, LIVE_SLOTS, int(liveBytes));
+		else if (gpuShape != GPU_NONE)
+			ImGui::Text("vertices uploaded: 0 (generated on the GPU)");
+		else if (showThick)
+			ImGui::Text("thick lines: %d segments in one instanced draw call", thick.segments());
+		else if (showFramebuffer)
+			ImGui::Text("texture uploaded: %dx%d, %d KB", framebuffer.width(), framebuffer.height(), int(framebuffer.bytes() / 1024));
+		else
+			ImGui::Text("vertices uploaded: %d", vertices.vertexCount());
+
+		ImGui::Text("\nBatch of random lines:");
+		ImGui::SliderInt("segments", &batchCount, 1000, 200000);
+		ImGui::SliderInt("max length", &batchLength, 1, 800);
+		ImGui::SliderInt("threads", &batchThreads, 1, batch.maxThreads());
+		if (ImGui::Button("Draw lines!")) {
+			randomSegments(segments, batchCount, batchLength);
+			ClipRect clip(view_width, view_height);
+			double start = glfwGetTime();
+			double seconds;
+			if (isThickMode) {
+				// nothing is rasterized on the CPU: one instance per segment
+				thickSegments.resize(4 * batchCount);
+				for (int i = 0; i < batchCount; i++) {
+					thickSegments[4 * i] = float(segments[i].x1);
+					thickSegments[4 * i + 1] = float(segments[i].y1);
+					thickSegments[4 * i + 2] = float(segments[i].x2);
+					thickSegments[4 * i + 3] = float(segments[i].y2);
+				}
+				thick.setSegments(thickSegments.data(), batchCount);
+				seconds = glfwGetTime() - start;
+				showThick = true;
+				gpuShape = GPU_NONE;
+			}
+			else if (isFramebufferMode) {
+				// the framebuffer is shared, so this path stays on one thread
+				beginFramebuffer();
+				for (int i = 0; i < batchCount; i++) {
+					const Segment& sg = segments[i];
+					if (isClipMode)
+						drawLineClipped(framebuffer, clip, sg.x1, sg.y1, sg.x2, sg.y2, isSpanMode);
+					else if (isSpanMode)
+						drawLineSpan(framebuffer, sg.x1, sg.y1, sg.x2, sg.y2);
+					else
+						drawLine(framebuffer, sg.x1, sg.y1, sg.x2, sg.y2);
+				}
+				seconds = glfwGetTime() - start;
+				uploadFramebuffer();
+			}
+			else if (isAAMode) {
+				batch.drawLinesAA(vertices, coverage, segments.data(), batchCount, batchThreads, isClipMode ? &clip : NULL);
+				seconds = glfwGetTime() - start;
+				drawMode = GL_POINTS;
+				uploadVertices();
+			}
+			else {
+				coverage.clear();
+				batch.drawLines(vertices, segments.data(), batchCount, isSpanMode, batchThreads, isClipMode ? &clip : NULL);
+				seconds = glfwGetTime() - start;
+				drawMode = isSpanMode ? GL_LINES : GL_POINTS;
+				uploadVertices();
+			}
+			clippedPixels = clip.Saved;
+			batchMs = float(seconds * 1000.0);
+			batchMpixels = seconds > 0.0 ? LineBatch::pixelCount(segments.data(), batchCount) / seconds / 1e6 : 0.0;
+		}
+		ImGui::Text("rasterized in %.2f ms, %.1f Mpixels/s", batchMs, batchMpixels);
+
+		// ģʽΣֻȽߵĺʱ
+		ImGui::Text("\nBatch of random polygons:");
+		ImGui::SliderInt("polygons", &polygonCount, 100, 20000);
+		ImGui::SliderInt("sides", &polygonSides, 3, 32);
+		ImGui::SliderInt("size", &polygonSize, 4, 400);
+		if (ImGui::Button("Draw polygons!")) {
+			randomPolygons(polygons, polygonCount, polygonSides, polygonSize);
+			ClipRect clip(view_width, view_height);
+			ClipRect* clipPtr = isClipMode ? &clip : NULL;
+			double start = glfwGetTime();
+			double seconds;
+			vertices.clear();
+			coverage.clear();
+			if (isFramebufferMode)
+				beginFramebuffer();
+			PointTarget target(vertices);
+			for (int i = 0; i < polygonCount; i++) {
+				const int* p = &polygons[2 * polygonSides * i];
+				if (isFramebufferMode)
+					drawPolygon(framebuffer, p, polygonSides, isFillMode, isSpanMode, clipPtr);
+				else
+					drawPolygon(target, p, polygonSides, isFillMode, isSpanMode, clipPtr);
+			}
+			seconds = glfwGetTime() - start;
+			if (isFramebufferMode) {
+				uploadFramebuffer();
+			}
+			else {
+				drawMode = (isFillMode || isSpanMode) ? GL_LINES : GL_POINTS;
+				uploadVertices();
+			}
+			clippedPixels = clip.Saved;
+			polygonMs = float(seconds * 1000.0);
+		}
+		ImGui::Text("%s in %.2f ms", isFillMode ? "filled" : "outlined", polygonMs);
+
+		// ֿ߳ΣǻCPU֡
+		ImGui::Text("\nBatch of filled triangles (64x64 tiles):");
+		ImGui::SliderInt("triangles", &triangleCount, 1000, 200000);
+		ImGui::SliderInt("triangle size", &triangleSize, 2, 400);
+		ImGui::SliderInt("tile threads", &tileThreads, 1, tiles.maxThreads());
+		if (ImGui::Button("Fill triangles!")) {
+			randomTriangles(triangles, triangleCount, triangleSize);
+			beginFramebuffer();
+			double start = glfwGetTime();
+			tiles.drawTriangles(framebuffer, triangles.data(), triangleCount, tileThreads);
+			double seconds = glfwGetTime() - start;
+			uploadFramebuffer();
+			tileMs = float(seconds * 1000.0);
+		}
+		ImGui::Text("filled in %.2f ms, %.2f Mtriangles/s", tileMs, tileMs > 0.0f ? triangleCount / (tileMs * 1000.0f) : 0.0f);
 		ImGui::End();
 		ImGui::Render();
 		ImGui_ImplGlfwGL3_RenderDrawData(ImGui::GetDrawData());
@@ -199,6 +762,13 @@ int main()
 	// optional: de-allocate all resources once they've outlived their purpose:
 	glDeleteVertexArrays(1, &VAO);
 	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &coverageVBO);
+	glDeleteVertexArrays(1, &quadVAO);
+	glDeleteVertexArrays(1, &liveVAO);
+	glDeleteBuffers(1, &liveVBO);
+	glDeleteBuffers(2, fbPBO);
+	glDeleteTextures(1, &fbTexture);
+	thick.release();
 
 	// glfw: terminate, clearing all previously allocated GLFW resources.
 	ImGui_ImplGlfwGL3_Shutdown();
@@ -226,83 +796,195 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 	view_width = width;
 }
 
-void drawLine(int x1, int y1, int x2, int y2) {
-	// жбǷ1ǶǷ45
-	int isKbig = (abs(y2 - y1) > abs(x2 - x1)) ? 1 : 0;
-	int temp;
-	// бʴ1xy
-	if (isKbig) {
-		temp = x1;
-		x1 = y1;
-		y1 = temp;
-		temp = x2;
-		x2 = y2;
-		y2 = temp;
-	}
-	// point1point2
-	if (x1 > x2) {
-		temp = x1;
-		x1 = x2;
-		x2 = temp;
-		temp = y1;
-		y1 = y2;
-		y2 = temp;
+// ϴ㣨ԼģʽµĸʣVBO
+void uploadVertices() {
+	uploadArrayBuffer(VBO, vboCapacity, vertices.data(), vertices.bytes());
+	hasCoverage = !coverage.empty();
+	if (hasCoverage)
+		uploadArrayBuffer(coverageVBO, coverageCapacity, &coverage[0], coverage.size());
+	showFramebuffer = false;
+	showThick = false;
+	gpuShape = GPU_NONE;
+}
+
+// ϴݵ㻺壺ʱŰ·䣬ֻеĴ洢
+void uploadArrayBuffer(unsigned int buffer, size_t& capacity, const void* data, size_t bytes) {
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	if (bytes > capacity) {
+		size_t newCapacity = capacity ? capacity : 4096;
+		while (newCapacity < bytes)
+			newCapacity *= 2;
+		glBufferData(GL_ARRAY_BUFFER, newCapacity, NULL, GL_DYNAMIC_DRAW);
+		capacity = newCapacity;
 	}
-	int dx = abs(x2 - x1);
-	int dy = abs(y2 - y1);
-	int dy2 = 2 * dy;
-	int dx2 = 2 * dx;
-	int dy2_dx2 = dy2 - dx2;
-	int yi = y1;
-	int p;
-	int addnum = (y1 < y2) ? 1 : -1;
-	p = 2 * dy - dx;
-	// ʹBresenham㷨ЩҪĶ
-	for (int xi = x1; xi <= x2; xi++) {
-		if (isKbig)
-			setPoint(yi, xi);
+	if (bytes > 0)
+		glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, data);
+}
+
+// ʵʱģʽֻ¹դ˵ͼԪεߺԲֻϴliveVBOеһΣ
+// ĳһηŲʱ·
+void updateLive(int pointT[3][2], int pointC[1][2], int radius) {
+	int params[LIVE_SLOTS][12] = {
+		{ pointT[0][0], pointT[0][1], pointT[1][0], pointT[1][1] },
+		{ pointT[1][0], pointT[1][1], pointT[2][0], pointT[2][1] },
+		{ pointT[0][0], pointT[0][1], pointT[2][0], pointT[2][1] },
+		{ pointC[0][0], pointC[0][1], radius, 0, 0, 0, 0, 0, conicShape, radiusY, arcStart, arcEnd },
+	};
+	bool dirty[LIVE_SLOTS];
+	bool relayout = false;
+	liveUpdated = 0;
+	liveBytes = 0;
+	for (int i = 0; i < LIVE_SLOTS; i++) {
+		// the output mode and the window size change the pixels as well
+		params[i][4] = isSpanMode;
+		params[i][5] = isClipMode;
+		params[i][6] = view_width;
+		params[i][7] = view_height;
+		dirty[i] = memcmp(params[i], liveParams[i], sizeof(params[i])) != 0;
+		if (!dirty[i])
+			continue;
+		memcpy(liveParams[i], params[i], sizeof(params[i]));
+		ClipRect clip(view_width, view_height);
+		ClipRect* clipPtr = isClipMode ? &clip : NULL;
+		liveSlots[i].clear();
+		PointTarget target(liveSlots[i]);
+		const int* p = params[i];
+		if (i == LIVE_CIRCLE)
+			drawConic(target, p[0], p[1], p[2], isSpanMode, clipPtr);
+		else if (clipPtr != NULL)
+			drawLineClipped(target, clip, p[0], p[1], p[2], p[3], isSpanMode);
+		else if (isSpanMode)
+			drawLineSpan(target, p[0], p[1], p[2], p[3]);
 		else
-			setPoint(xi, yi);
-		if (p <= 0) {
-			p += dy2;
-		}
-		else {
-			yi += addnum;
-			p += dy2_dx2;
+			drawLine(target, p[0], p[1], p[2], p[3]);
+		if (liveLayout.setCount(i, liveSlots[i].vertexCount()))
+			relayout = true;
+		liveUpdated++;
+	}
+	if (liveUpdated == 0)
+		return;
+
+	const size_t vertexBytes = 2 * sizeof(short);
+	glBindBuffer(GL_ARRAY_BUFFER, liveVBO);
+	if (relayout)
+		glBufferData(GL_ARRAY_BUFFER, liveLayout.totalCapacity() * vertexBytes, NULL, GL_DYNAMIC_DRAW);
+	for (int i = 0; i < LIVE_SLOTS; i++) {
+		if ((dirty[i] || relayout) && liveSlots[i].size() > 0) {
+			glBufferSubData(GL_ARRAY_BUFFER, liveLayout.first(i) * vertexBytes, liveSlots[i].bytes(), liveSlots[i].data());
+			liveBytes += liveSlots[i].bytes();
 		}
 	}
 }
 
-void drawCircle(int x, int y, int r) {
-	int p = 3 - 2 * r;
-	int yi = r;
-	for (int xi = 0; xi < yi; xi++) {
-		drawEightPoint(x, y, xi, yi);
-		if (p < 0) {
-			p = p + 2 * xi + 3;
-		}
-		else {
-			p = p + 2 * (xi - yi) + 5;
-			yi--;
+// ͨPBOϴCPU֡壺дǰPBOʱһεĴԻһPBOϽ
+void uploadFramebuffer() {
+	int width = framebuffer.width(), height = framebuffer.height();
+	size_t bytes = framebuffer.bytes();
+	glBindTexture(GL_TEXTURE_2D, fbTexture);
+	if (width != fbTexWidth || height != fbTexHeight) {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		fbTexWidth = width;
+		fbTexHeight = height;
+	}
+	showFramebuffer = true;
+	showThick = false;
+	gpuShape = GPU_NONE;
+	if (bytes == 0)
+		return;
+
+	fbPBOIndex = 1 - fbPBOIndex;
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, fbPBO[fbPBOIndex]);
+	// orphan the old storage so mapping never waits for the GPU
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+	void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (dst != NULL) {
+		memcpy(dst, framebuffer.data(), bytes);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+// 벢һɫ
+int createProgram(const char* vertexSource, const char* fragmentSource) {
+	// vertex shader
+	int vertexShader = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(vertexShader, 1, &vertexSource, NULL);
+	glCompileShader(vertexShader);
+	// check for shader compile errors
+	int success;
+	char infoLog[512];
+	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
+		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+	}
+	// fragment shader
+	int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(fragmentShader, 1, &fragmentSource, NULL);
+	glCompileShader(fragmentShader);
+	// check for shader compile errors
+	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
+		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+	}
+	// link shaders
+	int shaderProgram = glCreateProgram();
+	glAttachShader(shaderProgram, vertexShader);
+	glAttachShader(shaderProgram, fragmentShader);
+	glLinkProgram(shaderProgram);
+	// check for linking errors
+	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+	if (!success) {
+		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
+		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+	}
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+	return shaderProgram;
+}
+
+// countsidesΣֲԴĳΪġ߳Ϊsizeཻ
+void randomPolygons(vector<int>& points, int count, int sides, int size) {
+	points.resize(2 * count * sides);
+	for (int i = 0; i < count; i++) {
+		int cx = rand() % view_width, cy = rand() % view_height;
+		for (int j = 0; j < sides; j++) {
+			int* p = &points[2 * (sides * i + j)];
+			p[0] = cx + rand() % (size + 1) - size / 2;
+			p[1] = cy + rand() % (size + 1) - size / 2;
 		}
 	}
 }
-//(x0,y0)ڣ0,0Բ֮ƽƵx,y
-void drawEightPoint(int x, int y, int x0, int y0) {
-	setPoint(x0 + x, y0 + y);
-	setPoint(y0 + x, x0 + y);
-	setPoint(-y0 + x, x0 + y);
-	setPoint(-x0 + x, y0 + y);
-	setPoint(-x0 + x, -y0 + y);
-	setPoint(-y0 + x, -x0 + y);
-	setPoint(y0 + x, -x0 + y);
-	setPoint(x0 + x, -y0 + y);
+
+// countɫΣԴĳΪġ߳Ϊsize
+void randomTriangles(vector<Triangle>& triangles, int count, int size) {
+	triangles.resize(count);
+	for (int i = 0; i < count; i++) {
+		Triangle& t = triangles[i];
+		int cx = rand() % view_width, cy = rand() % view_height;
+		t.x1 = cx + rand() % (size + 1) - size / 2;
+		t.y1 = cy + rand() % (size + 1) - size / 2;
+		t.x2 = cx + rand() % (size + 1) - size / 2;
+		t.y2 = cy + rand() % (size + 1) - size / 2;
+		t.x3 = cx + rand() % (size + 1) - size / 2;
+		t.y3 = cy + rand() % (size + 1) - size / 2;
+		t.Color = Framebuffer::rgba(rand() % 256, rand() % 256, rand() % 256);
+	}
 }
 
-void setPoint(int x, int y) {
-	float flnum = x - (float(view_width)) / 2;
-	vertices[2 * pointCount] = flnum / (float(view_width) / 2);
-	flnum = y - (float(view_height)) / 2;
-	vertices[2 * pointCount + 1] = flnum / (float(view_height) / 2);
-	pointCount++;
-}
\ No newline at end of file
+// ߶ΣڴڣȲmaxLength
+void randomSegments(vector<Segment>& segments, int count, int maxLength) {
+	segments.resize(count);
+	for (int i = 0; i < count; i++) {
+		Segment& s = segments[i];
+		s.x1 = rand() % view_width;
+		s.y1 = rand() % view_height;
+		s.x2 = s.x1 + rand() % (2 * maxLength + 1) - maxLength;
+		s.y2 = s.y1 + rand() % (2 * maxLength + 1) - maxLength;
+	}
+}
@@ -0,0 +1,140 @@
+#ifndef POINT_BUFFER_H
+#define POINT_BUFFER_H
+
+#include <cstdlib>
+#include <cstring>
+
+// Range of the stored coordinates. Pixels outside of it can never be on screen, so they are
+// dropped (and spans cut) instead of being narrowed, which would wrap them around into view.
+const int COORD_MIN = -32768;
+const int COORD_MAX = 32767;
+
+inline bool coordFits(int v)
+{
+	return v >= COORD_MIN && v <= COORD_MAX;
+}
+
+// Growable arena for the 2D vertices produced by the rasterizer, stored as packed
+// int16 pixel coordinates (the vertex shader maps them to NDC from the viewport size).
+// clear() only rewinds the write position, so after the first few redraws the
+// storage is reused as is; when it does run out it doubles instead of overflowing.
+class PointBuffer
+{
+public:
+	PointBuffer(size_t initialShorts = 8192) : Data(NULL), Size(0), Capacity(0)
+	{
+		reserve(initialShorts);
+	}
+	~PointBuffer()
+	{
+		free(Data);
+	}
+
+	// drop the contents but keep the storage for the next redraw
+	void clear()
+	{
+		Size = 0;
+	}
+	// make sure at least n values fit without another allocation
+	void reserve(size_t n)
+	{
+		if (n <= Capacity)
+			return;
+		size_t newCapacity = Capacity ? Capacity : 64;
+		while (newCapacity < n)
+			newCapacity *= 2;
+		short* newData = (short*)realloc(Data, newCapacity * sizeof(short));
+		if (newData == NULL)
+			abort();
+		Data = newData;
+		Capacity = newCapacity;
+	}
+	// append n values and return where to write them
+	short* alloc(size_t n)
+	{
+		if (Size + n > Capacity)
+			reserve(Size + n);
+		short* p = Data + Size;
+		Size += n;
+		return p;
+	}
+	// points outside the int16 range are dropped
+	void push(int x, int y)
+	{
+		if (!coordFits(x) || !coordFits(y))
+			return;
+		short* p = alloc(2);
+		p[0] = (short)x;
+		p[1] = (short)y;
+	}
+
+	const short* data() const { return Data; }
+	size_t size() const { return Size; }
+	size_t bytes() const { return Size * sizeof(short); }
+	int vertexCount() const { return int(Size / 2); }
+
+private:
+	short* Data;
+	size_t Size;
+	size_t Capacity;
+
+	PointBuffer(const PointBuffer&);
+	PointBuffer& operator=(const PointBuffer&);
+};
+
+// Rasterizer target (see bresenham.h) that appends pixels to a PointBuffer.
+// A point is one vertex; a span is two vertices, the start pixel and one past the end pixel,
+// meant to be drawn as GL_LINES through pixel centers. Pixels outside the int16 range are
+// dropped: points entirely, spans are cut to the part that still fits (with room for the
+// end vertex one past the last pixel).
+class PointTarget
+{
+public:
+	PointTarget(PointBuffer& buffer) : Buffer(buffer)
+	{
+	}
+
+	void point(int x, int y)
+	{
+		if (!coordFits(x) || !coordFits(y))
+			return;
+		short* v = Buffer.alloc(2);
+		v[0] = (short)x;
+		v[1] = (short)y;
+	}
+	void span(int x0, int y0, int x1, int y1)
+	{
+		if (y0 == y1) {
+			if (!coordFits(y0) || !cut(x0, x1))
+				return;
+		}
+		else if (!coordFits(x0) || !cut(y0, y1)) {
+			return;
+		}
+		short* v = Buffer.alloc(4);
+		v[0] = (short)x0;
+		v[1] = (short)y0;
+		if (y0 == y1) {
+			v[2] = (short)(x1 + 1);
+			v[3] = (short)y1;
+		}
+		else {
+			v[2] = (short)x1;
+			v[3] = (short)(y1 + 1);
+		}
+	}
+
+private:
+	PointBuffer& Buffer;
+
+	// the run a..b cut to the representable pixels; false when nothing is left
+	static bool cut(int& a, int& b)
+	{
+		if (a < COORD_MIN)
+			a = COORD_MIN;
+		if (b > COORD_MAX - 1)
+			b = COORD_MAX - 1;
+		return a <= b;
+	}
+};
+#endif
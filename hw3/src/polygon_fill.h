@@ -0,0 +1,201 @@
+#ifndef POLYGON_FILL_H
+#define POLYGON_FILL_H
+
+#include <algorithm>
+#include <vector>
+#include "clip.h"
+
+enum FillRule { FILL_EVEN_ODD, FILL_NON_ZERO };
+
+// Scanline polygon fill with an edge table and an active edge table.
+// Pixel (x, y) is inside when its center is: an edge covers the rows y0 <= y < y1 and a run
+// between two crossings xl and xr covers ceil(xl) <= x < ceil(xr), so polygons sharing an
+// edge never fill the same pixel twice. Every run is emitted as one span of the Target (see
+// bresenham.h). Crossings are stepped with exact integer arithmetic, no floating point.
+// The tables are kept between calls, so filling thousands of polygons a frame does not
+// allocate after the first few.
+class ScanlineFill
+{
+public:
+	ScanlineFill()
+	{
+	}
+
+	// fill one polygon given as count (x, y) pairs in xy
+	template <typename Target>
+	void fillPolygon(Target& target, const int* xy, int count, FillRule rule, const ClipRect* clip = NULL)
+	{
+		fillContours(target, xy, &count, 1, rule, clip);
+	}
+
+	// fill a polygon made of several closed contours (holes, islands) stored one after the
+	// other in xy; counts[i] is the number of points of contour i
+	template <typename Target>
+	void fillContours(Target& target, const int* xy, const int* counts, int contours, FillRule rule, const ClipRect* clip = NULL)
+	{
+		int yBegin, yEnd;
+		if (!buildEdgeTable(xy, counts, contours, yBegin, yEnd))
+			return;
+		int xMin = -0x7fffffff, xEnd = 0x7fffffff;
+		if (clip != NULL) {
+			yBegin = std::max(yBegin, clip->YMin);
+			yEnd = std::min(yEnd, clip->YMax + 1);
+			xMin = clip->XMin;
+			xEnd = clip->XMax + 1;
+		}
+
+		Active.clear();
+		size_t next = 0;
+		for (int y = yBegin; y < yEnd; y++) {
+			// drop the edges that ended below this row
+			size_t kept = 0;
+			for (size_t i = 0; i < Active.size(); i++) {
+				if (Edges[Active[i]].YEnd > y)
+					Active[kept++] = Active[i];
+			}
+			Active.resize(kept);
+			// bring in the edges starting on (or, after clipping, before) this row
+			for (; next < Edges.size() && Edges[next].YStart <= y; next++) {
+				if (Edges[next].YEnd <= y)
+					continue;
+				startAt(Edges[next], y);
+				Active.push_back((int)next);
+			}
+			// the list stays almost sorted from row to row, so insertion sort is enough
+			for (size_t i = 1; i < Active.size(); i++) {
+				int e = Active[i];
+				size_t j = i;
+				for (; j > 0 && Edges[Active[j - 1]].X > Edges[e].X; j--)
+					Active[j] = Active[j - 1];
+				Active[j] = e;
+			}
+
+			if (rule == FILL_EVEN_ODD) {
+				for (size_t i = 0; i + 1 < Active.size(); i += 2)
+					emitSpan(target, Edges[Active[i]].X, Edges[Active[i + 1]].X, y, xMin, xEnd);
+			}
+			else {
+				int winding = 0, start = 0;
+				for (size_t i = 0; i < Active.size(); i++) {
+					const Edge& edge = Edges[Active[i]];
+					if (winding == 0)
+						start = edge.X;
+					winding += edge.Winding;
+					if (winding == 0)
+						emitSpan(target, start, edge.X, y, xMin, xEnd);
+				}
+			}
+
+			for (size_t i = 0; i < Active.size(); i++)
+				step(Edges[Active[i]]);
+		}
+	}
+
+	// number of pixels fillPolygon / fillContours would produce, for throughput numbers
+	long long pixelCount(const int* xy, const int* counts, int contours, FillRule rule)
+	{
+		Counter counter;
+		fillContours(counter, xy, counts, contours, rule);
+		return counter.Pixels;
+	}
+
+private:
+	// X is ceil of the crossing with the current row, kept as X = x0 + q with the remainder
+	// R = q * Dy - (y - YStart) * Dx in [0, Dy); going up one row adds Dx / Dy
+	struct Edge
+	{
+		int YStart, YEnd;
+		int X0, Dx, Dy;
+		int X, R;
+		int StepQ, StepR;
+		int Winding;
+
+		bool operator<(const Edge& other) const
+		{
+			return YStart < other.YStart;
+		}
+	};
+
+	struct Counter
+	{
+		long long Pixels;
+		Counter() : Pixels(0) {}
+		void span(int x0, int, int x1, int) { Pixels += x1 - x0 + 1; }
+	};
+
+	std::vector<Edge> Edges;
+	std::vector<int> Active;
+
+	// edge table: the non-horizontal edges sorted by their first row; false if there are none
+	bool buildEdgeTable(const int* xy, const int* counts, int contours, int& yBegin, int& yEnd)
+	{
+		Edges.clear();
+		yBegin = 0x7fffffff;
+		yEnd = -0x7fffffff;
+		const int* p = xy;
+		for (int c = 0; c < contours; c++) {
+			int n = counts[c];
+			for (int i = 0; i < n; i++) {
+				int j = i + 1 < n ? i + 1 : 0;
+				int xa = p[2 * i], ya = p[2 * i + 1], xb = p[2 * j], yb = p[2 * j + 1];
+				if (ya == yb)
+					continue;
+				Edge e;
+				e.Winding = ya < yb ? 1 : -1;
+				if (ya > yb) {
+					std::swap(xa, xb);
+					std::swap(ya, yb);
+				}
+				e.YStart = ya;
+				e.YEnd = yb;
+				e.X0 = xa;
+				e.Dx = xb - xa;
+				e.Dy = yb - ya;
+				e.StepQ = (int)floorDiv(e.Dx, e.Dy);
+				e.StepR = e.Dx - e.StepQ * e.Dy;
+				Edges.push_back(e);
+				yBegin = std::min(yBegin, ya);
+				yEnd = std::max(yEnd, yb);
+			}
+			p += 2 * n;
+		}
+		if (Edges.empty())
+			return false;
+		std::sort(Edges.begin(), Edges.end());
+		return true;
+	}
+
+	static void startAt(Edge& e, int y)
+	{
+		long long num = (long long)(y - e.YStart) * e.Dx;
+		long long q = ceilDiv(num, e.Dy);
+		e.X = int(e.X0 + q);
+		e.R = int(q * e.Dy - num);
+	}
+
+	static void step(Edge& e)
+	{
+		e.X += e.StepQ;
+		e.R -= e.StepR;
+		if (e.R < 0) {
+			e.X++;
+			e.R += e.Dy;
+		}
+	}
+
+	// pixels xl <= x < xr of row y, limited to xMin <= x < xEnd
+	template <typename Target>
+	static void emitSpan(Target& target, int xl, int xr, int y, int xMin, int xEnd)
+	{
+		if (xl < xMin)
+			xl = xMin;
+		if (xr > xEnd)
+			xr = xEnd;
+		if (xl < xr)
+			target.span(xl, y, xr - 1, y);
+	}
+
+	ScanlineFill(const ScanlineFill&);
+	ScanlineFill& operator=(const ScanlineFill&);
+};
+#endif
@@ -0,0 +1,70 @@
+#ifndef SLOT_LAYOUT_H
+#define SLOT_LAYOUT_H
+
+#include <vector>
+
+// Layout of independently updated primitives in one vertex buffer: slot i owns the vertices
+// [first(i), first(i) + capacity) and uses the first count(i) of them. A slot that still fits
+// is updated in place (one glBufferSubData of its range); when one outgrows its capacity the
+// whole layout is rebuilt with a quarter more room than it needs (in blocks of 64 vertices),
+// so that happens rarely while dragging without doubling the buffer of a large document.
+// firsts() / counts() are laid out for glMultiDrawArrays.
+class SlotLayout
+{
+public:
+	SlotLayout(int slots = 0)
+	{
+		resize(slots);
+	}
+
+	void resize(int slots)
+	{
+		First.assign(slots, 0);
+		Count.assign(slots, 0);
+		Capacity.assign(slots, 0);
+		Total = 0;
+	}
+
+	// append an empty slot at the end; it gets room on its first setCount
+	int addSlot()
+	{
+		First.push_back(Total);
+		Count.push_back(0);
+		Capacity.push_back(0);
+		return slots() - 1;
+	}
+
+	// set the number of vertices of a slot; true if the layout had to be rebuilt, in which
+	// case every slot has moved and the buffer needs totalCapacity() vertices
+	bool setCount(int slot, int vertices)
+	{
+		Count[slot] = vertices;
+		if (vertices <= Capacity[slot])
+			return false;
+		Total = 0;
+		for (size_t i = 0; i < First.size(); i++) {
+			if (Count[i] > Capacity[i])
+				Capacity[i] = (Count[i] + Count[i] / 4 + 63) / 64 * 64;
+			First[i] = Total;
+			Total += Capacity[i];
+		}
+		return true;
+	}
+
+	// whether setCount(slot, vertices) would keep the layout as it is
+	bool fits(int slot, int vertices) const { return vertices <= Capacity[slot]; }
+
+	int slots() const { return (int)First.size(); }
+	int first(int slot) const { return First[slot]; }
+	int count(int slot) const { return Count[slot]; }
+	int totalCapacity() const { return Total; }
+	const int* firsts() const { return First.empty() ? NULL : &First[0]; }
+	const int* counts() const { return Count.empty() ? NULL : &Count[0]; }
+
+private:
+	std::vector<int> First;
+	std::vector<int> Count;
+	std::vector<int> Capacity;
+	int Total;
+};
+#endif
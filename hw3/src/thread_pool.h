@@ -0,0 +1,102 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads that are kept alive between frames.
+// run() hands out job indices to the workers (the calling thread helps as well)
+// and returns once every index has been processed.
+class ThreadPool
+{
+public:
+	ThreadPool(unsigned int threads = std::thread::hardware_concurrency()) : Job(NULL), JobCount(0), Next(0), Active(0), Generation(0), Quit(false)
+	{
+		if (threads == 0)
+			threads = 1;
+		for (unsigned int i = 1; i < threads; i++)
+			Workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+	}
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(Mutex);
+			Quit = true;
+		}
+		WakeCv.notify_all();
+		for (size_t i = 0; i < Workers.size(); i++)
+			Workers[i].join();
+	}
+
+	// number of threads taking part in run(), including the caller
+	unsigned int size() const
+	{
+		return (unsigned int)Workers.size() + 1;
+	}
+
+	// call job(i) for every i in [0, count) and wait until all of them are done
+	void run(int count, const std::function<void(int)>& job)
+	{
+		std::unique_lock<std::mutex> lock(Mutex);
+		Job = &job;
+		JobCount = count;
+		Next = 0;
+		Active = (int)Workers.size();
+		Generation++;
+		lock.unlock();
+		WakeCv.notify_all();
+
+		work();
+
+		lock.lock();
+		DoneCv.wait(lock, [this] { return Active == 0; });
+		Job = NULL;
+	}
+
+private:
+	std::vector<std::thread> Workers;
+	std::mutex Mutex;
+	std::condition_variable WakeCv;
+	std::condition_variable DoneCv;
+	const std::function<void(int)>* Job;
+	int JobCount;
+	std::atomic<int> Next;
+	int Active;
+	unsigned int Generation;
+	bool Quit;
+
+	void work()
+	{
+		int i;
+		while ((i = Next.fetch_add(1)) < JobCount)
+			(*Job)(i);
+	}
+
+	void workerLoop()
+	{
+		unsigned int seen = 0;
+		for (;;) {
+			{
+				std::unique_lock<std::mutex> lock(Mutex);
+				WakeCv.wait(lock, [&] { return Quit || Generation != seen; });
+				if (Quit)
+					return;
+				seen = Generation;
+			}
+			work();
+			{
+				std::lock_guard<std::mutex> lock(Mutex);
+				if (--Active == 0)
+					DoneCv.notify_one();
+			}
+		}
+	}
+
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator=(const ThreadPool&);
+};
+#endif
@@ -0,0 +1,279 @@
+#ifndef TILE_RASTER_H
+#define TILE_RASTER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <vector>
+#include "framebuffer.h"
+#include "thread_pool.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TILE_RASTER_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TILE_RASTER_SSE2
+#endif
+
+struct Triangle
+{
+	int x1, y1, x2, y2, x3, y3;
+	unsigned int Color;
+};
+
+// Filled triangles into a Framebuffer, binned into 64x64 tiles that the thread pool shares out.
+// Each triangle is set up once as three half-space edge functions E(x, y) = A * x + B * y + C,
+// positive inside; a pixel is covered when its center (x, y) is inside all three, and pixels
+// exactly on an edge follow the same rule as ScanlineFill (left and bottom edges are in,
+// right and top edges out), so triangles sharing an edge never overlap or leave gaps.
+// Within a tile the edge functions are evaluated 8 pixels at a time with AVX2 (4 with SSE2).
+// A tile is written by one thread only and visits its triangles in submission order, so the
+// image is the same as drawing the triangles one by one.
+//
+// The edge functions are 32-bit so the SIMD rows can hold 8 (or 4) of them. An edge function
+// is E = -dy * (x - xi) + dx * (y - yi), so with vertices and pixels within +-MAX_COORD every
+// factor is at most 2 * MAX_COORD and |E| <= 8 * MAX_COORD^2 (plus 8 steps of A past the end
+// of a row in drawRow): 2.05e9 for 16000, under INT_MAX. Triangles outside that range are
+// rejected, and only the first MAX_COORD + 1 rows and columns of a larger framebuffer are
+// drawn (both assert in debug builds).
+class TileRasterizer
+{
+public:
+	static const int TILE = 64;
+	static const int MAX_COORD = 16000;
+
+	TileRasterizer(unsigned int threads = std::thread::hardware_concurrency()) : Pool(threads)
+	{
+	}
+
+	unsigned int maxThreads() const
+	{
+		return Pool.size();
+	}
+
+	// draw count triangles into framebuffer using up to `threads` threads
+	void drawTriangles(Framebuffer& framebuffer, const Triangle* triangles, int count, unsigned int threads)
+	{
+		Stride = framebuffer.width();
+		Width = std::min(framebuffer.width(), MAX_COORD + 1);
+		Height = std::min(framebuffer.height(), MAX_COORD + 1);
+		assert(framebuffer.width() <= MAX_COORD + 1 && framebuffer.height() <= MAX_COORD + 1);
+		if (Width == 0 || Height == 0 || count == 0)
+			return;
+		TilesX = (Width + TILE - 1) / TILE;
+		TilesY = (Height + TILE - 1) / TILE;
+		int tiles = TilesX * TilesY;
+		int chunks = threads < 1 ? 1 : (int)threads;
+		if (chunks > count)
+			chunks = count;
+		Setups.resize(count);
+		if ((int)Bins.size() < chunks)
+			Bins.resize(chunks);
+
+		// set up and bin: every chunk of triangles gets its own bins, so no locking is needed
+		Pool.run(chunks, [&](int c) {
+			std::vector<std::vector<int> >& bins = Bins[c];
+			bins.resize(tiles);
+			for (int t = 0; t < tiles; t++)
+				bins[t].clear();
+			int begin = int((long long)count * c / chunks);
+			int end = int((long long)count * (c + 1) / chunks);
+			for (int i = begin; i < end; i++) {
+				Setup& s = Setups[i];
+				if (!setup(triangles[i], s))
+					continue;
+				for (int ty = s.YMin / TILE; ty <= s.YMax / TILE; ty++)
+					for (int tx = s.XMin / TILE; tx <= s.XMax / TILE; tx++)
+						bins[ty * TilesX + tx].push_back(i);
+			}
+		});
+
+		// rasterize: threads take tiles until none are left
+		NextTile = 0;
+		unsigned int* pixels = framebuffer.row(0);
+		Pool.run(threads < 1 ? 1 : (int)threads, [&](int) {
+			int t;
+			while ((t = NextTile.fetch_add(1)) < tiles) {
+				for (int c = 0; c < chunks; c++) {
+					const std::vector<int>& bin = Bins[c][t];
+					for (size_t i = 0; i < bin.size(); i++)
+						drawInTile(pixels, Setups[bin[i]], t % TilesX, t / TilesX);
+				}
+			}
+		});
+	}
+
+private:
+	// edge i is inside where A[i] * x + B[i] * y + C[i] > 0; the on-edge rule is folded into C
+	struct Setup
+	{
+		int A[3], B[3], C[3];
+		int XMin, YMin, XMax, YMax;
+		unsigned int Color;
+	};
+
+	ThreadPool Pool;
+	std::vector<Setup> Setups;
+	std::vector<std::vector<std::vector<int> > > Bins;
+	std::atomic<int> NextTile;
+	// the region drawn, and the row length of the framebuffer
+	int Width, Height, Stride;
+	int TilesX, TilesY;
+
+	// false for degenerate triangles, triangles outside the image and triangles whose edge
+	// functions could overflow
+	bool setup(const Triangle& tri, Setup& s) const
+	{
+		int x[3] = { tri.x1, tri.x2, tri.x3 }, y[3] = { tri.y1, tri.y2, tri.y3 };
+		for (int i = 0; i < 3; i++) {
+			bool inRange = x[i] >= -MAX_COORD && x[i] <= MAX_COORD && y[i] >= -MAX_COORD && y[i] <= MAX_COORD;
+			assert(inRange);
+			if (!inRange)
+				return false;
+		}
+		long long area = (long long)(x[1] - x[0]) * (y[2] - y[0]) - (long long)(x[2] - x[0]) * (y[1] - y[0]);
+		if (area == 0)
+			return false;
+		if (area < 0) {
+			std::swap(x[1], x[2]);
+			std::swap(y[1], y[2]);
+		}
+		s.XMin = std::max(std::min(x[0], std::min(x[1], x[2])), 0);
+		s.YMin = std::max(std::min(y[0], std::min(y[1], y[2])), 0);
+		s.XMax = std::min(std::max(x[0], std::max(x[1], x[2])), Width - 1);
+		s.YMax = std::min(std::max(y[0], std::max(y[1], y[2])), Height - 1);
+		if (s.XMin > s.XMax || s.YMin > s.YMax)
+			return false;
+		for (int i = 0; i < 3; i++) {
+			int j = i < 2 ? i + 1 : 0;
+			int dx = x[j] - x[i], dy = y[j] - y[i];
+			// counter-clockwise, so the inside is to the left of every edge
+			s.A[i] = -dy;
+			s.B[i] = dx;
+			s.C[i] = dy * x[i] - dx * y[i];
+			// pixels on a left (going down) or bottom (going right) edge are in: E >= 0 there
+			if (dy < 0 || (dy == 0 && dx > 0))
+				s.C[i]++;
+		}
+		s.Color = tri.Color;
+		return true;
+	}
+
+	enum BlockCover { BLOCK_OUT, BLOCK_FULL, BLOCK_PARTIAL };
+
+	// an edge function is linear, so its extremes over a block are at two of its corners
+	static BlockCover classify(const Setup& s, int x0, int y0, int x1, int y1)
+	{
+		BlockCover cover = BLOCK_FULL;
+		for (int i = 0; i < 3; i++) {
+			int lo = s.A[i] * (s.A[i] > 0 ? x0 : x1) + s.B[i] * (s.B[i] > 0 ? y0 : y1) + s.C[i];
+			int hi = s.A[i] * (s.A[i] > 0 ? x1 : x0) + s.B[i] * (s.B[i] > 0 ? y1 : y0) + s.C[i];
+			if (hi <= 0)
+				return BLOCK_OUT;
+			if (lo <= 0)
+				cover = BLOCK_PARTIAL;
+		}
+		return cover;
+	}
+
+	// the part of the triangle inside tile (tx, ty): the tile is skipped when it is outside one
+	// edge and filled without tests when inside all three
+	void drawInTile(unsigned int* pixels, const Setup& s, int tx, int ty) const
+	{
+		int x0 = std::max(s.XMin, tx * TILE), x1 = std::min(s.XMax, tx * TILE + TILE - 1);
+		int y0 = std::max(s.YMin, ty * TILE), y1 = std::min(s.YMax, ty * TILE + TILE - 1);
+		if (x0 > x1 || y0 > y1)
+			return;
+		BlockCover cover = classify(s, x0, y0, x1, y1);
+		if (cover != BLOCK_PARTIAL) {
+			if (cover == BLOCK_FULL)
+				fillBlock(pixels, s, x0, y0, x1, y1);
+			return;
+		}
+		for (int y = y0; y <= y1; y++) {
+			int e[3];
+			for (int i = 0; i < 3; i++)
+				e[i] = s.A[i] * x0 + s.B[i] * y + s.C[i];
+			drawRow(pixels + (size_t)y * Stride, s, e, x0, x1);
+		}
+	}
+
+	void fillBlock(unsigned int* pixels, const Setup& s, int x0, int y0, int x1, int y1) const
+	{
+		for (int y = y0; y <= y1; y++)
+			std::fill(pixels + (size_t)y * Stride + x0, pixels + (size_t)y * Stride + x1 + 1, s.Color);
+	}
+
+#if defined(TILE_RASTER_AVX2)
+	// pixels x0..x1 of one row; e holds the edge functions at x0
+	static void drawRow(unsigned int* row, const Setup& s, const int e[3], int x0, int x1)
+	{
+		const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		const __m256i color = _mm256_set1_epi32((int)s.Color);
+		__m256i e0 = _mm256_add_epi32(_mm256_set1_epi32(e[0]), _mm256_mullo_epi32(_mm256_set1_epi32(s.A[0]), lane));
+		__m256i e1 = _mm256_add_epi32(_mm256_set1_epi32(e[1]), _mm256_mullo_epi32(_mm256_set1_epi32(s.A[1]), lane));
+		__m256i e2 = _mm256_add_epi32(_mm256_set1_epi32(e[2]), _mm256_mullo_epi32(_mm256_set1_epi32(s.A[2]), lane));
+		const __m256i step0 = _mm256_set1_epi32(s.A[0] * 8), step1 = _mm256_set1_epi32(s.A[1] * 8), step2 = _mm256_set1_epi32(s.A[2] * 8);
+		const __m256i zero = _mm256_setzero_si256();
+		for (int x = x0; x <= x1; x += 8) {
+			// inside: all three > 0
+			__m256i in = _mm256_and_si256(_mm256_cmpgt_epi32(e0, zero), _mm256_and_si256(_mm256_cmpgt_epi32(e1, zero), _mm256_cmpgt_epi32(e2, zero)));
+			if (x1 - x < 7)
+				in = _mm256_and_si256(in, _mm256_cmpgt_epi32(_mm256_set1_epi32(x1 - x + 1), lane));
+			if (!_mm256_testz_si256(in, in))
+				_mm256_maskstore_epi32((int*)(row + x), in, color);
+			e0 = _mm256_add_epi32(e0, step0);
+			e1 = _mm256_add_epi32(e1, step1);
+			e2 = _mm256_add_epi32(e2, step2);
+		}
+	}
+#elif defined(TILE_RASTER_SSE2)
+	static void drawRow(unsigned int* row, const Setup& s, const int e[3], int x0, int x1)
+	{
+		const __m128i color = _mm_set1_epi32((int)s.Color);
+		__m128i e0 = _mm_setr_epi32(e[0], e[0] + s.A[0], e[0] + 2 * s.A[0], e[0] + 3 * s.A[0]);
+		__m128i e1 = _mm_setr_epi32(e[1], e[1] + s.A[1], e[1] + 2 * s.A[1], e[1] + 3 * s.A[1]);
+		__m128i e2 = _mm_setr_epi32(e[2], e[2] + s.A[2], e[2] + 2 * s.A[2], e[2] + 3 * s.A[2]);
+		const __m128i step0 = _mm_set1_epi32(s.A[0] * 4), step1 = _mm_set1_epi32(s.A[1] * 4), step2 = _mm_set1_epi32(s.A[2] * 4);
+		const __m128i zero = _mm_setzero_si128();
+		int x = x0;
+		for (; x + 3 <= x1; x += 4) {
+			__m128i in = _mm_and_si128(_mm_cmpgt_epi32(e0, zero), _mm_and_si128(_mm_cmpgt_epi32(e1, zero), _mm_cmpgt_epi32(e2, zero)));
+			if (_mm_movemask_epi8(in) != 0) {
+				__m128i* p = (__m128i*)(row + x);
+				__m128i old = _mm_loadu_si128(p);
+				_mm_storeu_si128(p, _mm_or_si128(_mm_and_si128(in, color), _mm_andnot_si128(in, old)));
+			}
+			e0 = _mm_add_epi32(e0, step0);
+			e1 = _mm_add_epi32(e1, step1);
+			e2 = _mm_add_epi32(e2, step2);
+		}
+		// the last few pixels one by one
+		int f[3] = { _mm_cvtsi128_si32(e0), _mm_cvtsi128_si32(e1), _mm_cvtsi128_si32(e2) };
+		for (; x <= x1; x++) {
+			if (f[0] > 0 && f[1] > 0 && f[2] > 0)
+				row[x] = s.Color;
+			f[0] += s.A[0];
+			f[1] += s.A[1];
+			f[2] += s.A[2];
+		}
+	}
+#else
+	static void drawRow(unsigned int* row, const Setup& s, const int e[3], int x0, int x1)
+	{
+		int f[3] = { e[0], e[1], e[2] };
+		for (int x = x0; x <= x1; x++) {
+			if (f[0] > 0 && f[1] > 0 && f[2] > 0)
+				row[x] = s.Color;
+			f[0] += s.A[0];
+			f[1] += s.A[1];
+			f[2] += s.A[2];
+		}
+	}
+#endif
+
+	TileRasterizer(const TileRasterizer&);
+	TileRasterizer& operator=(const TileRasterizer&);
+};
+#endif
@@ -0,0 +1,350 @@
+// Headless benchmark for the hw8 curve evaluators (no window / GL needed).
+//
+// build: g++ -O2 -std=c++11 -I../src bezier_bench.cpp -o bezier_bench
+// run:   bezier_bench [--json] [--out file] [--quick]
+//
+// Every evaluator produces the samples drawBezier uploads (2001 points by default, or the
+// adaptive polyline) for a set of random curves, and is reported as ns per curve and ns per
+// point, together with its largest distance from the exact curve in pixels of the 1280x720
+// window. The arc length rows time ArcLengthTable: its error is how far the table's length is
+// from the true length, and for the sampling rows how far along the curve a sample is from
+// where even spacing would put it. The simplify rows reduce the 2001 samples with
+// simplifyPolyline and report the time of the reduction alone. --json prints the results as
+// JSON so they can be tracked across releases; --out writes the same JSON to a file.
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "bezier.h"
+#include "arc_length.h"
+#include "simplify.h"
+
+using namespace std;
+
+const int CURVES = 64;
+
+struct Result
+{
+	string kernel;
+	string params;
+	long long curves;
+	long long points;
+	double seconds;
+	double maxError;
+};
+
+vector<Result> results;
+double minSeconds = 0.2;
+
+// keep calling batch() until minSeconds have passed; returns seconds per call
+template <typename F>
+double timeBatch(F batch) {
+	typedef chrono::steady_clock clock;
+	batch();
+	long long calls = 0;
+	clock::time_point start = clock::now();
+	double elapsed = 0.0;
+	do {
+		batch();
+		calls++;
+		elapsed = chrono::duration<double>(clock::now() - start).count();
+	} while (elapsed < minSeconds);
+	return elapsed / calls;
+}
+
+void record(const char* kernel, const string& params, long long curves, long long points, double seconds, double maxError) {
+	Result r;
+	r.kernel = kernel;
+	r.params = params;
+	r.curves = curves;
+	r.points = points;
+	r.seconds = seconds;
+	r.maxError = maxError;
+	results.push_back(r);
+}
+
+// random control points in NDC, like the ones placed by clicking
+vector<float> makeCurves() {
+	vector<float> p(8 * CURVES);
+	srand(1);
+	for (size_t i = 0; i < p.size(); i++)
+		p[i] = rand() / float(RAND_MAX) * 2.0f - 1.0f;
+	return p;
+}
+
+// what drawBezier did before: calQ at t accumulated in float, and the end point added
+void sampleCalQ(const float* p, int steps, float* out) {
+	float t = 0.0;
+	float dt = 1.0f / steps;
+	for (int i = 0; i < steps; i++) {
+		out[2 * i] = calQ(p, t, 0);
+		out[2 * i + 1] = calQ(p, t, 1);
+		t += dt;
+	}
+	out[2 * steps] = p[6];
+	out[2 * steps + 1] = p[7];
+}
+
+// largest distance of the samples from the curve at t = i / steps, in window pixels
+double maxError(const float* p, int steps, const float* samples) {
+	double worst = 0.0;
+	for (int i = 0; i <= steps; i++) {
+		double t = double(i) / steps, s = 1.0 - t;
+		double b0 = s * s * s, b1 = 3 * t * s * s, b2 = 3 * t * t * s, b3 = t * t * t;
+		double x = b0 * p[0] + b1 * p[2] + b2 * p[4] + b3 * p[6];
+		double y = b0 * p[1] + b1 * p[3] + b2 * p[5] + b3 * p[7];
+		double dx = (samples[2 * i] - x) * 640.0, dy = (samples[2 * i + 1] - y) * 360.0;
+		double d = sqrt(dx * dx + dy * dy);
+		if (d > worst)
+			worst = d;
+	}
+	return worst;
+}
+
+// distance from a point to segment a-b
+double segmentDistance(double x, double y, double ax, double ay, double bx, double by) {
+	double dx = bx - ax, dy = by - ay;
+	double len2 = dx * dx + dy * dy;
+	double t = len2 > 0.0 ? ((x - ax) * dx + (y - ay) * dy) / len2 : 0.0;
+	t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+	double ex = ax + t * dx - x, ey = ay + t * dy - y;
+	return sqrt(ex * ex + ey * ey);
+}
+
+// largest distance of the exact curve from a polyline, in window pixels; the curve is sampled
+// densely and every sample is measured against the nearest segment
+double polylineError(const float* p, const vector<float>& poly) {
+	const int SAMPLES = 4000;
+	int segments = (int)poly.size() / 2 - 1;
+	double worst = 0.0;
+	for (int i = 0; i <= SAMPLES; i++) {
+		double t = double(i) / SAMPLES, s = 1.0 - t;
+		double b0 = s * s * s, b1 = 3 * t * s * s, b2 = 3 * t * t * s, b3 = t * t * t;
+		double x = (b0 * p[0] + b1 * p[2] + b2 * p[4] + b3 * p[6]) * 640.0;
+		double y = (b0 * p[1] + b1 * p[3] + b2 * p[5] + b3 * p[7]) * 360.0;
+		double nearest = 1e30;
+		for (int k = 0; k < segments; k++)
+			nearest = min(nearest, segmentDistance(x, y, poly[2 * k] * 640.0, poly[2 * k + 1] * 360.0,
+				poly[2 * k + 2] * 640.0, poly[2 * k + 3] * 360.0));
+		worst = max(worst, nearest);
+	}
+	return worst;
+}
+
+template <typename F>
+void benchEvaluator(const char* kernel, F evaluate, int steps) {
+	vector<float> curves = makeCurves();
+	vector<float> out(2 * (steps + 1));
+	char params[64];
+	sprintf(params, "steps=%d", steps);
+	double error = 0.0;
+	for (int c = 0; c < CURVES; c++) {
+		evaluate(&curves[8 * c], steps, &out[0]);
+		error = max(error, maxError(&curves[8 * c], steps, &out[0]));
+	}
+	double t = timeBatch([&] {
+		for (int c = 0; c < CURVES; c++)
+			evaluate(&curves[8 * c], steps, &out[0]);
+	});
+	record(kernel, params, CURVES, (long long)CURVES * (steps + 1), t, error);
+}
+
+// adaptive subdivision: the number of points depends on the curve, and the error is the
+// distance between the curve and the polyline, not just at the samples
+void benchFlatten(float tolerance) {
+	vector<float> curves = makeCurves();
+	vector<float> poly;
+	char params[64];
+	sprintf(params, "tolerance=%gpx", tolerance);
+	long long points = 0;
+	double error = 0.0;
+	for (int c = 0; c < CURVES; c++) {
+		points += flattenCubic(&curves[8 * c], tolerance, 640.0f, 360.0f, poly);
+		error = max(error, polylineError(&curves[8 * c], poly));
+	}
+	double t = timeBatch([&] {
+		for (int c = 0; c < CURVES; c++)
+			flattenCubic(&curves[8 * c], tolerance, 640.0f, 360.0f, poly);
+	});
+	record("flattenCubic", params, CURVES, points, t, error);
+}
+
+// the 2001 uniform samples simplified: points kept per curve, time of the simplification, and
+// how far the exact curve gets from the simplified polyline
+void benchSimplify(float tolerance) {
+	const int STEPS = 2000;
+	vector<float> curves = makeCurves();
+	vector<vector<float> > samples(CURVES, vector<float>(2 * (STEPS + 1)));
+	vector<float> poly;
+	for (int c = 0; c < CURVES; c++)
+		evalCubic(&curves[8 * c], STEPS, &samples[c][0]);
+	char params[64];
+	sprintf(params, "tolerance=%gpx", tolerance);
+	long long points = 0;
+	double error = 0.0;
+	for (int c = 0; c < CURVES; c++) {
+		points += simplifyPolyline(&samples[c][0], STEPS + 1, tolerance, 640.0f, 360.0f, poly);
+		error = max(error, polylineError(&curves[8 * c], poly));
+	}
+	double t = timeBatch([&] {
+		for (int c = 0; c < CURVES; c++)
+			simplifyPolyline(&samples[c][0], STEPS + 1, tolerance, 640.0f, 360.0f, poly);
+	});
+	record("simplifyPolyline", params, CURVES, points, t, error);
+}
+
+// running length of the curve in window pixels at t = i / FINE, from a very fine polyline
+const int FINE = 100000;
+vector<double> fineLengths(const float* p) {
+	vector<float> poly(2 * (FINE + 1));
+	evalCubic(p, FINE, &poly[0]);
+	vector<double> lengths(FINE + 1, 0.0);
+	for (int i = 0; i < FINE; i++) {
+		double dx = (poly[2 * i + 2] - poly[2 * i]) * 640.0, dy = (poly[2 * i + 3] - poly[2 * i + 1]) * 360.0;
+		lengths[i + 1] = lengths[i] + sqrt(dx * dx + dy * dy);
+	}
+	return lengths;
+}
+
+// largest distance along the curve between sample i (at t[i]) and where even spacing puts it,
+// i * length / steps, in pixels
+double spacingError(const vector<double>& lengths, const vector<float>& t) {
+	int steps = (int)t.size() - 1;
+	double worst = 0.0;
+	for (int i = 0; i <= steps; i++) {
+		double f = t[i] * FINE;
+		int k = min((int)f, FINE - 1);
+		double s = lengths[k] + (lengths[k + 1] - lengths[k]) * (f - k);
+		worst = max(worst, fabs(s - lengths[FINE] * i / steps));
+	}
+	return worst;
+}
+
+void benchArcLength(int tableSamples, int steps) {
+	vector<float> curves = makeCurves();
+	vector<ArcLengthTable> tables(CURVES);
+	vector<vector<double> > lengths(CURVES);
+	float x[4], y[4];
+	char params[64];
+
+	// building the tables
+	double error = 0.0;
+	for (int c = 0; c < CURVES; c++) {
+		for (int i = 0; i < 4; i++) {
+			x[i] = curves[8 * c + 2 * i];
+			y[i] = curves[8 * c + 2 * i + 1];
+		}
+		tables[c].build(x, y, 4, tableSamples, 640.0f, 360.0f);
+		lengths[c] = fineLengths(&curves[8 * c]);
+		error = max(error, fabs(tables[c].length() - lengths[c][FINE]));
+	}
+	double t = timeBatch([&] {
+		for (int c = 0; c < CURVES; c++) {
+			for (int i = 0; i < 4; i++) {
+				x[i] = curves[8 * c + 2 * i];
+				y[i] = curves[8 * c + 2 * i + 1];
+			}
+			tables[c].build(x, y, 4, tableSamples, 640.0f, 360.0f);
+		}
+	});
+	sprintf(params, "samples=%d", tableSamples);
+	record("arcLength build", params, CURVES, (long long)CURVES * (tableSamples + 1), t, error);
+
+	// steps + 1 samples evenly spaced along each curve, against the same number evenly in t
+	vector<float> out(2 * (steps + 1)), ts(steps + 1);
+	double uniformError = 0.0;
+	error = 0.0;
+	for (int c = 0; c < CURVES; c++) {
+		for (int i = 0; i <= steps; i++)
+			ts[i] = float(i) / steps;
+		uniformError = max(uniformError, spacingError(lengths[c], ts));
+		for (int i = 0; i <= steps; i++)
+			ts[i] = tables[c].parameterAt(tables[c].length() * i / steps);
+		error = max(error, spacingError(lengths[c], ts));
+	}
+	t = timeBatch([&] {
+		for (int c = 0; c < CURVES; c++) {
+			for (int i = 0; i < 4; i++) {
+				x[i] = curves[8 * c + 2 * i];
+				y[i] = curves[8 * c + 2 * i + 1];
+			}
+			for (int i = 0; i <= steps; i++)
+				bezierPoint(x, y, 4, tables[c].parameterAt(tables[c].length() * i / steps), out[2 * i], out[2 * i + 1]);
+		}
+	});
+	sprintf(params, "steps=%d", steps);
+	record("constantSpeed", params, CURVES, (long long)CURVES * (steps + 1), t, error);
+	t = timeBatch([&] {
+		for (int c = 0; c < CURVES; c++)
+			evalCubic(&curves[8 * c], steps, &out[0]);
+	});
+	record("uniform t spacing", params, CURVES, (long long)CURVES * (steps + 1), t, uniformError);
+}
+
+void printTable() {
+	printf("%-18s %-18s %14s %14s %14s %16s\n", "kernel", "params", "points/curve", "ns/curve", "ns/point", "max error (px)");
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result& r = results[i];
+		printf("%-18s %-18s %14.1f %14.1f %14.2f %16.6f\n", r.kernel.c_str(), r.params.c_str(), double(r.points) / r.curves,
+			r.seconds / r.curves * 1e9, r.seconds / r.points * 1e9, r.maxError);
+	}
+}
+
+void printJson(FILE* f) {
+	fprintf(f, "{\n  \"benchmark\": \"hw8-bezier\",\n  \"results\": [\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result& r = results[i];
+		fprintf(f, "    {\"kernel\": \"%s\", \"params\": \"%s\", \"curves\": %lld, \"points\": %lld, "
+			"\"ns_per_curve\": %.3f, \"ns_per_point\": %.3f, \"max_error_px\": %.6f}%s\n",
+			r.kernel.c_str(), r.params.c_str(), r.curves, r.points,
+			r.seconds / r.curves * 1e9, r.seconds / r.points * 1e9, r.maxError, i + 1 < results.size() ? "," : "");
+	}
+	fprintf(f, "  ]\n}\n");
+}
+
+int main(int argc, char** argv) {
+	bool json = false;
+	const char* outPath = NULL;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--json") == 0)
+			json = true;
+		else if (strcmp(argv[i], "--quick") == 0)
+			minSeconds = 0.02;
+		else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+			outPath = argv[++i];
+		else {
+			fprintf(stderr, "usage: %s [--json] [--out file] [--quick]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	const int steps[] = { 100, 2000, 20000 };
+	for (int s = 0; s < 3; s++) {
+		benchEvaluator("calQ", sampleCalQ, steps[s]);
+		benchEvaluator("evalCubic", evalCubic, steps[s]);
+	}
+	const float tolerances[] = { 0.1f, 0.5f, 2.0f };
+	for (int t = 0; t < 3; t++)
+		benchFlatten(tolerances[t]);
+	benchArcLength(128, 200);
+	for (int t = 0; t < 3; t++)
+		benchSimplify(tolerances[t]);
+
+	if (json)
+		printJson(stdout);
+	else
+		printTable();
+	if (outPath != NULL) {
+		FILE* f = fopen(outPath, "w");
+		if (f == NULL) {
+			fprintf(stderr, "cannot write %s\n", outPath);
+			return 1;
+		}
+		printJson(f);
+		fclose(f);
+	}
+	return 0;
+}
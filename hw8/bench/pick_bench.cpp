@@ -0,0 +1,203 @@
+// Headless benchmark for control point picking in hw8 (no window / GL needed).
+//
+// build: g++ -O2 -std=c++11 -I../src pick_bench.cpp -o pick_bench
+// run:   pick_bench [--json] [--out file] [--quick]
+//
+// Random clicks against documents of random control points, answered by the linear scan
+// mouse_button_callback used to do and by PickGrid, as ns per query; "misses" counts the
+// clicks where the grid disagrees with the scan and must be 0. A drag row times
+// PickGrid::move for points wandering across the document and past its bounds. The "x50" rows
+// spread the document over 50 windows, clicked with the view zoomed out to show all of it.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "pick_grid.h"
+
+using namespace std;
+
+const int QUERIES = 4096;
+// a 12 pixel pick radius in the 1280x720 window, in world units at zoom 1
+const float PICK_X = 12.0f / 640.0f;
+const float PICK_Y = 12.0f / 360.0f;
+float RADIUS_X = PICK_X;
+float RADIUS_Y = PICK_Y;
+
+struct Result
+{
+	string kernel;
+	int points;
+	double seconds;
+	long long queries;
+	int misses;
+};
+
+vector<Result> results;
+double minSeconds = 0.2;
+
+// keep calling batch() until minSeconds have passed; returns seconds per call
+template <typename F>
+double timeBatch(F batch) {
+	typedef chrono::steady_clock clock;
+	batch();
+	long long calls = 0;
+	clock::time_point start = clock::now();
+	double elapsed = 0.0;
+	do {
+		batch();
+		calls++;
+		elapsed = chrono::duration<double>(clock::now() - start).count();
+	} while (elapsed < minSeconds);
+	return elapsed / calls;
+}
+
+void record(const char* kernel, int points, double seconds, long long queries, int misses) {
+	Result r;
+	r.kernel = kernel;
+	r.points = points;
+	r.seconds = seconds;
+	r.queries = queries;
+	r.misses = misses;
+	results.push_back(r);
+}
+
+float random(float lo, float hi) {
+	return lo + rand() / float(RAND_MAX) * (hi - lo);
+}
+
+// nearest point within the pick radius by looking at all of them, -1 if none
+int linearPick(const vector<float>& x, const vector<float>& y, float px, float py) {
+	int best = -1;
+	float bestDistance = 1.0f;
+	for (size_t i = 0; i < x.size(); i++) {
+		float dx = (x[i] - px) / RADIUS_X, dy = (y[i] - py) / RADIUS_Y;
+		float d = dx * dx + dy * dy;
+		if (d <= bestDistance) {
+			best = (int)i;
+			bestDistance = d;
+		}
+	}
+	return best;
+}
+
+// points in [-extent, extent] on both axes, seen at zoom 1 / extent
+void benchPick(int points, float extent) {
+	srand(points);
+	RADIUS_X = PICK_X * extent;
+	RADIUS_Y = PICK_Y * extent;
+	string suffix = extent == 1.0f ? "" : " x" + to_string((int)extent);
+	vector<float> x(points), y(points), qx(QUERIES), qy(QUERIES);
+	for (int i = 0; i < points; i++) {
+		x[i] = random(-extent, extent);
+		y[i] = random(-extent, extent);
+	}
+	// half the clicks right next to a point, half anywhere
+	for (int i = 0; i < QUERIES; i++) {
+		if (i % 2 == 0) {
+			int p = rand() % points;
+			qx[i] = x[p] + random(-0.5f, 0.5f) * RADIUS_X;
+			qy[i] = y[p] + random(-0.5f, 0.5f) * RADIUS_Y;
+		}
+		else {
+			qx[i] = random(-extent, extent);
+			qy[i] = random(-extent, extent);
+		}
+	}
+	PickGrid grid;
+	grid.build(&x[0], &y[0], points);
+
+	int misses = 0;
+	for (int i = 0; i < QUERIES; i++)
+		if (grid.nearest(qx[i], qy[i], RADIUS_X, RADIUS_Y) != linearPick(x, y, qx[i], qy[i]))
+			misses++;
+
+	volatile int sink = 0;
+	double t = timeBatch([&] {
+		for (int i = 0; i < QUERIES; i++)
+			sink += linearPick(x, y, qx[i], qy[i]);
+	});
+	record(("linear" + suffix).c_str(), points, t, QUERIES, 0);
+	t = timeBatch([&] {
+		for (int i = 0; i < QUERIES; i++)
+			sink += grid.nearest(qx[i], qy[i], RADIUS_X, RADIUS_Y);
+	});
+	record(("grid" + suffix).c_str(), points, t, QUERIES, misses);
+
+	// dragging: every query moves one point, the way applyDrag does, some of them out to half
+	// as far again as the document reached
+	for (int i = 0; i < QUERIES; i++) {
+		qx[i] *= 1.5f;
+		qy[i] *= 1.5f;
+	}
+	t = timeBatch([&] {
+		for (int i = 0; i < QUERIES; i++) {
+			int p = i % points;
+			x[p] = qx[i];
+			y[p] = qy[i];
+			grid.move(p, x[p], y[p]);
+		}
+	});
+	misses = 0;
+	for (int i = 0; i < QUERIES; i++)
+		if (grid.nearest(qx[i], qy[i], RADIUS_X, RADIUS_Y) != linearPick(x, y, qx[i], qy[i]))
+			misses++;
+	record(("grid move" + suffix).c_str(), points, t, QUERIES, misses);
+}
+
+void printTable() {
+	printf("%-16s %10s %14s %8s\n", "kernel", "points", "ns/query", "misses");
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result& r = results[i];
+		printf("%-16s %10d %14.1f %8d\n", r.kernel.c_str(), r.points, r.seconds / r.queries * 1e9, r.misses);
+	}
+}
+
+void printJson(FILE* f) {
+	fprintf(f, "{\n  \"benchmark\": \"hw8-pick\",\n  \"results\": [\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result& r = results[i];
+		fprintf(f, "    {\"kernel\": \"%s\", \"points\": %d, \"ns_per_query\": %.3f, \"misses\": %d}%s\n",
+			r.kernel.c_str(), r.points, r.seconds / r.queries * 1e9, r.misses, i + 1 < results.size() ? "," : "");
+	}
+	fprintf(f, "  ]\n}\n");
+}
+
+int main(int argc, char** argv) {
+	bool json = false;
+	const char* outPath = NULL;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--json") == 0)
+			json = true;
+		else if (strcmp(argv[i], "--quick") == 0)
+			minSeconds = 0.02;
+		else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+			outPath = argv[++i];
+		else {
+			fprintf(stderr, "usage: %s [--json] [--out file] [--quick]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	const int sizes[] = { 16, 1000, 10000, 100000 };
+	for (int s = 0; s < 4; s++)
+		benchPick(sizes[s], 1.0f);
+	for (int s = 0; s < 4; s++)
+		benchPick(sizes[s], 50.0f);
+
+	if (json)
+		printJson(stdout);
+	else
+		printTable();
+	if (outPath != NULL) {
+		FILE* f = fopen(outPath, "w");
+		if (f == NULL) {
+			fprintf(stderr, "cannot write %s\n", outPath);
+			return 1;
+		}
+		printJson(f);
+		fclose(f);
+	}
+	return 0;
+}
@@ -0,0 +1,59 @@
+#ifndef ARC_LENGTH_H
+#define ARC_LENGTH_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "bezier.h"
+
+// Arc length of a Bezier curve as a function of t, for placing things at constant speed along
+// it: equally spaced samples, dashes, markers. build() walks the curve once at samples + 1
+// uniform values of t and keeps the running length (in pixels through scaleX, scaleY) at each;
+// parameterAt(s) inverts it with a binary search and a linear step in between, so moving a
+// marker or re-spacing the samples never integrates the curve again until it changes.
+class ArcLengthTable
+{
+public:
+	ArcLengthTable()
+	{
+	}
+
+	void build(const float* x, const float* y, int count, int samples, float scaleX, float scaleY)
+	{
+		Lengths.clear();
+		if (count <= 0 || samples < 1)
+			return;
+		std::vector<float> points(2 * (samples + 1));
+		evalBezier(x, y, count, samples, &points[0]);
+		Lengths.resize(samples + 1);
+		double length = 0.0;
+		Lengths[0] = 0.0f;
+		for (int i = 1; i <= samples; i++) {
+			double dx = (points[2 * i] - points[2 * i - 2]) * scaleX, dy = (points[2 * i + 1] - points[2 * i - 1]) * scaleY;
+			length += std::sqrt(dx * dx + dy * dy);
+			Lengths[i] = float(length);
+		}
+	}
+
+	bool empty() const { return Lengths.empty(); }
+	float length() const { return Lengths.empty() ? 0.0f : Lengths.back(); }
+
+	// t at which the curve is s pixels long (s clamped to 0 .. length())
+	float parameterAt(float s) const
+	{
+		int samples = (int)Lengths.size() - 1;
+		if (samples < 1 || s <= 0.0f)
+			return 0.0f;
+		if (s >= Lengths.back())
+			return 1.0f;
+		// first sample at least s long; s lies in the step before it
+		int i = int(std::lower_bound(Lengths.begin(), Lengths.end(), s) - Lengths.begin());
+		float step = Lengths[i] - Lengths[i - 1];
+		float f = step > 0.0f ? (s - Lengths[i - 1]) / step : 0.0f;
+		return (i - 1 + f) / samples;
+	}
+
+private:
+	std::vector<float> Lengths;
+};
+#endif
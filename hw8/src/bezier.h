@@ -0,0 +1,247 @@
+#ifndef BEZIER_H
+#define BEZIER_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Bezier evaluation. The cubic versions take four (x, y) pairs, p[0..7], in the order the user
+// placed them; the versions for any number of control points take them as separate x and y
+// arrays, the way CurveDocument stores them.
+
+// Point of the curve at t, x (isx = 0) or y (isx = 1) coordinate, straight from the Bernstein
+// form. Exact but slow: four pow() calls per coordinate.
+inline float calQ(const float* p, float t, int isx) {
+	float result = pow(1 - t, 3) * p[isx + 0] + 3 * t * pow(1 - t, 2) * p[isx + 2];
+	result += 3 * t * t * (1 - t) * p[isx + 4] + pow(t, 3) * p[isx + 6];
+	return result;
+}
+
+// steps + 1 samples of the curve at t = i / steps into out (x, y interleaved), by forward
+// differencing: the cubic becomes a * t^3 + b * t^2 + c * t + d, and stepping it by h only
+// needs three additions per coordinate. The differences are kept in double so 2000 steps do
+// not drift, and the last sample is the end point exactly.
+inline void evalCubic(const float* p, int steps, float* out) {
+	if (steps < 1) {
+		out[0] = p[0];
+		out[1] = p[1];
+		return;
+	}
+	double h = 1.0 / steps;
+	double f[2], d1[2], d2[2], d3[2];
+	for (int k = 0; k < 2; k++) {
+		double p0 = p[k], p1 = p[k + 2], p2 = p[k + 4], p3 = p[k + 6];
+		double a = -p0 + 3 * p1 - 3 * p2 + p3;
+		double b = 3 * p0 - 6 * p1 + 3 * p2;
+		double c = -3 * p0 + 3 * p1;
+		f[k] = p0;
+		d1[k] = (a * h + b) * h * h + c * h;
+		d2[k] = (6 * a * h + 2 * b) * h * h;
+		d3[k] = 6 * a * h * h * h;
+	}
+	// x and y advance together, which the compiler turns into packed adds
+	for (int i = 0; i < steps; i++) {
+		out[2 * i] = float(f[0]);
+		out[2 * i + 1] = float(f[1]);
+		for (int k = 0; k < 2; k++) {
+			f[k] += d1[k];
+			d1[k] += d2[k];
+			d2[k] += d3[k];
+		}
+	}
+	out[2 * steps] = p[6];
+	out[2 * steps + 1] = p[7];
+}
+
+// Adaptive flattening by de Casteljau subdivision: a piece is split in half until it is flat,
+// i.e. it stays within tolerance pixels of its chord, and then replaced by that chord. The
+// curve never gets further from the chord than max(|3 P1 - 2 P0 - P3|, |3 P2 - P0 - 2 P3|) / 4,
+// measured in pixels through (scaleX, scaleY). Nearly straight curves end up with a handful of
+// points, tight bends get as many as they need.
+// The polyline (x, y interleaved, end points included) replaces the contents of out; returns
+// its number of points.
+inline int flattenCubic(const float* p, float tolerance, float scaleX, float scaleY, std::vector<float>& out) {
+	// pieces still to test, depth first so the points come out in order along the curve;
+	// 16 halvings are far below a pixel for anything on screen
+	const int MAX_DEPTH = 16;
+	struct Piece
+	{
+		float c[8];
+		int depth;
+	};
+	Piece stack[MAX_DEPTH + 1];
+	int top = 0;
+	for (int i = 0; i < 8; i++)
+		stack[0].c[i] = p[i];
+	stack[0].depth = 0;
+	out.clear();
+	out.push_back(p[0]);
+	out.push_back(p[1]);
+	// the squared bound against 16 * tolerance^2, so the test needs no sqrt
+	double limit = 16.0 * tolerance * tolerance;
+	while (top >= 0) {
+		Piece piece = stack[top--];
+		const float* c = piece.c;
+		double ux = (3.0 * c[2] - 2.0 * c[0] - c[6]) * scaleX, uy = (3.0 * c[3] - 2.0 * c[1] - c[7]) * scaleY;
+		double vx = (3.0 * c[4] - c[0] - 2.0 * c[6]) * scaleX, vy = (3.0 * c[5] - c[1] - 2.0 * c[7]) * scaleY;
+		double flat = std::max(ux * ux + uy * uy, vx * vx + vy * vy);
+		if (flat <= limit || piece.depth == MAX_DEPTH) {
+			out.push_back(c[6]);
+			out.push_back(c[7]);
+			continue;
+		}
+		// split at t = 0.5; the second half goes on the stack first so the first is done first
+		Piece left, right;
+		for (int k = 0; k < 2; k++) {
+			float p01 = (c[k] + c[k + 2]) * 0.5f, p12 = (c[k + 2] + c[k + 4]) * 0.5f, p23 = (c[k + 4] + c[k + 6]) * 0.5f;
+			float p012 = (p01 + p12) * 0.5f, p123 = (p12 + p23) * 0.5f;
+			float mid = (p012 + p123) * 0.5f;
+			left.c[k] = c[k];
+			left.c[k + 2] = p01;
+			left.c[k + 4] = p012;
+			left.c[k + 6] = mid;
+			right.c[k] = mid;
+			right.c[k + 2] = p123;
+			right.c[k + 4] = p23;
+			right.c[k + 6] = c[k + 6];
+		}
+		left.depth = right.depth = piece.depth + 1;
+		stack[++top] = right;
+		stack[++top] = left;
+	}
+	return (int)out.size() / 2;
+}
+
+// the four control points of a cubic from separate x / y arrays, as p[0..7]
+inline void gatherCubic(const float* x, const float* y, float* p) {
+	for (int i = 0; i < 4; i++) {
+		p[2 * i] = x[i];
+		p[2 * i + 1] = y[i];
+	}
+}
+
+// evalCubic for any number of control points: steps + 1 samples at t = i / steps into out.
+// Cubics go through evalCubic, other degrees through de Casteljau's algorithm per sample
+// (O(count^2), but stable for any degree).
+inline void evalBezier(const float* x, const float* y, int count, int steps, float* out) {
+	if (count <= 0)
+		return;
+	if (count == 4) {
+		float p[8];
+		gatherCubic(x, y, p);
+		evalCubic(p, steps, out);
+		return;
+	}
+	if (steps < 1)
+		steps = 1;
+	std::vector<float> bx(count), by(count);
+	for (int i = 0; i <= steps; i++) {
+		float t = float(i) / steps;
+		bx.assign(x, x + count);
+		by.assign(y, y + count);
+		for (int r = count - 1; r > 0; r--) {
+			for (int k = 0; k < r; k++) {
+				bx[k] += t * (bx[k + 1] - bx[k]);
+				by[k] += t * (by[k + 1] - by[k]);
+			}
+		}
+		out[2 * i] = bx[0];
+		out[2 * i + 1] = by[0];
+	}
+}
+
+// the point of the curve at t into (px, py), by de Casteljau's algorithm
+inline void bezierPoint(const float* x, const float* y, int count, float t, float& px, float& py) {
+	if (count <= 0)
+		return;
+	// the usual degrees need no allocation
+	float sx[16], sy[16];
+	std::vector<float> vx, vy;
+	float* bx = sx;
+	float* by = sy;
+	if (count > 16) {
+		vx.resize(count);
+		vy.resize(count);
+		bx = &vx[0];
+		by = &vy[0];
+	}
+	std::copy(x, x + count, bx);
+	std::copy(y, y + count, by);
+	for (int r = count - 1; r > 0; r--) {
+		for (int k = 0; k < r; k++) {
+			bx[k] += t * (bx[k + 1] - bx[k]);
+			by[k] += t * (by[k + 1] - by[k]);
+		}
+	}
+	px = bx[0];
+	py = by[0];
+}
+
+// flattenCubic for any number of control points. Other degrees use the convex hull: a piece
+// is flat when all its control points are within tolerance pixels of its chord.
+inline int flattenBezier(const float* x, const float* y, int count, float tolerance, float scaleX, float scaleY, std::vector<float>& out) {
+	out.clear();
+	if (count <= 0)
+		return 0;
+	if (count == 4) {
+		float p[8];
+		gatherCubic(x, y, p);
+		return flattenCubic(p, tolerance, scaleX, scaleY, out);
+	}
+	out.push_back(x[0]);
+	out.push_back(y[0]);
+	if (count == 1)
+		return 1;
+	// pieces still to test as 2 * count floats (x then y) and their depth, depth first
+	const int MAX_DEPTH = 16;
+	std::vector<float> stack((MAX_DEPTH + 1) * 2 * count), level(2 * count);
+	std::vector<int> depth(MAX_DEPTH + 1);
+	std::copy(x, x + count, stack.begin());
+	std::copy(y, y + count, stack.begin() + count);
+	depth[0] = 0;
+	int top = 0;
+	double limit = (double)tolerance * tolerance;
+	while (top >= 0) {
+		float* c = &stack[top * 2 * count];
+		const float* cy = c + count;
+		int d = depth[top];
+		// largest squared distance of the inner control points from the chord, in pixels
+		double ax = c[0] * scaleX, ay = cy[0] * scaleY;
+		double dx = c[count - 1] * scaleX - ax, dy = cy[count - 1] * scaleY - ay;
+		double len2 = dx * dx + dy * dy;
+		double flat = 0.0;
+		for (int k = 1; k < count - 1; k++) {
+			double px = c[k] * scaleX - ax, py = cy[k] * scaleY - ay;
+			// distance to the segment, not the line: a point beyond an end is not flat
+			double t = len2 > 0.0 ? (px * dx + py * dy) / len2 : 0.0;
+			t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+			double ex = px - t * dx, ey = py - t * dy;
+			flat = std::max(flat, ex * ex + ey * ey);
+		}
+		if (flat <= limit || d == MAX_DEPTH) {
+			out.push_back(c[count - 1]);
+			out.push_back(cy[count - 1]);
+			top--;
+			continue;
+		}
+		// de Casteljau at t = 0.5: the left half is the first point of every level, the
+		// right half the last one. The right half replaces this piece, the left goes on top
+		std::copy(c, c + 2 * count, level.begin());
+		float* left = c + 2 * count;
+		for (int r = count - 1; r >= 0; r--) {
+			int n = count - 1 - r;
+			left[n] = level[0];
+			left[count + n] = level[count];
+			c[r] = level[r];
+			c[count + r] = level[count + r];
+			for (int k = 0; k < r; k++) {
+				level[k] = (level[k] + level[k + 1]) * 0.5f;
+				level[count + k] = (level[count + k] + level[count + k + 1]) * 0.5f;
+			}
+		}
+		depth[top] = depth[top + 1] = d + 1;
+		top++;
+	}
+	return (int)out.size() / 2;
+}
+#endif
@@ -0,0 +1,42 @@
+#version 330 core
+
+// One instance per curve, one vertex per sample: vertex i of an instance is the point of its
+// curve at t = i / steps. The control points of the whole document are in two buffer
+// textures (x and y, as CurveDocument stores them); the instance knows where its curve starts
+// and how many points it has.
+layout (location = 0) in ivec2 aCurve;
+
+uniform samplerBuffer pointsX;
+uniform samplerBuffer pointsY;
+uniform int steps;
+// world to NDC: p * view.xy + view.zw
+uniform vec4 view = vec4(1.0, 1.0, 0.0, 0.0);
+
+const int MAX_POINTS = 16;
+
+void main() {
+	int count = min(aCurve.y, MAX_POINTS);
+	// empty curves (and the one still being placed) are moved out of the clip volume
+	if (count == 0) {
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+		return;
+	}
+	float t = float(gl_VertexID) / float(steps);
+	vec2 p[MAX_POINTS];
+	for (int i = 0; i < count; i++)
+		p[i] = vec2(texelFetch(pointsX, aCurve.x + i).r, texelFetch(pointsY, aCurve.x + i).r);
+	vec2 result;
+	if (count == 4) {
+		// cubic: the Bernstein weights directly
+		float s = 1.0 - t;
+		result = s * s * s * p[0] + 3.0 * t * s * s * p[1] + 3.0 * t * t * s * p[2] + t * t * t * p[3];
+	}
+	else {
+		// any other degree: de Casteljau, the Bernstein form evaluated by repeated lerps
+		for (int r = count - 1; r > 0; r--)
+			for (int k = 0; k < r; k++)
+				p[k] = mix(p[k], p[k + 1], t);
+		result = p[0];
+	}
+	gl_Position = vec4(result * view.xy + view.zw, 0.0, 1.0);
+}
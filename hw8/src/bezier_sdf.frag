@@ -0,0 +1,91 @@
+#version 330 core
+
+// Distance from the pixel to the curve, in pixels, turned into coverage. Nothing is sampled
+// ahead of time, so the stroke is as smooth at any zoom as at the first one. The nearest point
+// is found by a coarse search over 4 * count values of t, then a few Gauss-Newton steps on
+// (B(t) - p) . B'(t) = 0 from the best two separate candidates (one is not enough where the
+// curve passes close to itself).
+flat in ivec2 curve;
+
+uniform samplerBuffer pointsX;
+uniform samplerBuffer pointsY;
+uniform vec4 view;
+uniform vec2 viewport;
+uniform float halfWidth;
+uniform vec3 ourColor;
+
+out vec4 FragColor;
+
+const int MAX_POINTS = 16;
+vec2 points[MAX_POINTS];
+int count;
+
+// point b and derivative d of the curve at t; de Casteljau down to the last two points,
+// whose difference is the tangent
+void evaluate(float t, out vec2 b, out vec2 d) {
+	if (count == 1) {
+		b = points[0];
+		d = vec2(0.0);
+		return;
+	}
+	vec2 q[MAX_POINTS];
+	for (int i = 0; i < count; i++)
+		q[i] = points[i];
+	for (int r = count - 1; r > 1; r--)
+		for (int k = 0; k < r; k++)
+			q[k] = mix(q[k], q[k + 1], t);
+	b = mix(q[0], q[1], t);
+	d = float(count - 1) * (q[1] - q[0]);
+}
+
+// distance from p to the curve near t after a few Gauss-Newton steps
+float refine(vec2 p, float t) {
+	vec2 b, d;
+	for (int i = 0; i < 4; i++) {
+		evaluate(t, b, d);
+		float dd = dot(d, d);
+		if (dd <= 0.0)
+			break;
+		t = clamp(t - dot(b - p, d) / dd, 0.0, 1.0);
+	}
+	evaluate(t, b, d);
+	return length(b - p);
+}
+
+void main() {
+	count = curve.y;
+	for (int i = 0; i < count; i++) {
+		vec2 w = vec2(texelFetch(pointsX, curve.x + i).r, texelFetch(pointsY, curve.x + i).r);
+		points[i] = ((w * view.xy + view.zw) * 0.5 + 0.5) * viewport;
+	}
+	vec2 p = gl_FragCoord.xy;
+
+	int n = 4 * count;
+	float gap = 1.5 / float(n);
+	float best = 1e30, second = 1e30;
+	float bestT = 0.0, secondT = 0.0;
+	vec2 b, d;
+	for (int i = 0; i <= n; i++) {
+		float t = float(i) / float(n);
+		evaluate(t, b, d);
+		float dist = dot(b - p, b - p);
+		if (dist < best) {
+			if (abs(t - bestT) > gap) {
+				second = best;
+				secondT = bestT;
+			}
+			best = dist;
+			bestT = t;
+		}
+		else if (dist < second && abs(t - bestT) > gap) {
+			second = dist;
+			secondT = t;
+		}
+	}
+	float nearest = min(sqrt(best), min(refine(p, bestT), refine(p, secondT)));
+
+	float alpha = clamp(halfWidth + 0.5 - nearest, 0.0, 1.0);
+	if (alpha <= 0.0)
+		discard;
+	FragColor = vec4(ourColor, alpha);
+}
@@ -0,0 +1,39 @@
+#version 330 core
+
+// Distance field strokes: one instance per curve, drawn as the quad over the bounding box of
+// its control points (the curve lies in their convex hull) grown by the stroke width, so an
+// off-screen curve costs nothing and a visible one only the pixels near it. bezier_sdf.frag
+// decides which of those pixels the stroke covers. The control points come from the same
+// buffer textures as bezier.vert.
+layout (location = 0) in ivec2 aCurve;
+
+uniform samplerBuffer pointsX;
+uniform samplerBuffer pointsY;
+uniform vec4 view;
+uniform vec2 viewport;
+uniform float halfWidth;
+
+flat out ivec2 curve;
+
+const int MAX_POINTS = 16;
+
+void main() {
+	int count = min(aCurve.y, MAX_POINTS);
+	curve = ivec2(aCurve.x, count);
+	// empty curves (and the one still being placed) are moved out of the clip volume
+	if (count == 0) {
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+		return;
+	}
+	vec2 lo = vec2(1e30), hi = vec2(-1e30);
+	for (int i = 0; i < count; i++) {
+		vec2 p = vec2(texelFetch(pointsX, aCurve.x + i).r, texelFetch(pointsY, aCurve.x + i).r) * view.xy + view.zw;
+		lo = min(lo, p);
+		hi = max(hi, p);
+	}
+	// half the width and one more pixel for the anti-aliased edge, in NDC
+	vec2 grow = (halfWidth + 1.0) * 2.0 / viewport;
+	lo -= grow;
+	hi += grow;
+	gl_Position = vec4((gl_VertexID & 1) != 0 ? hi.x : lo.x, (gl_VertexID & 2) != 0 ? hi.y : lo.y, 0.0, 1.0);
+}
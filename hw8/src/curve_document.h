@@ -0,0 +1,120 @@
+#ifndef CURVE_DOCUMENT_H
+#define CURVE_DOCUMENT_H
+
+#include <algorithm>
+#include <vector>
+
+// A drawing made of Bezier curves with any number of control points each. All control points
+// live in one pool as separate x and y arrays (structure of arrays), curve after curve, so
+// curve i is the points first(i) .. first(i) + count(i) - 1 and a whole document is a couple
+// of contiguous arrays, whatever the number of curves. Points are only ever appended to the
+// last curve, which keeps the pool contiguous.
+//
+// Every change marks its curve dirty; dirtyCurves() lists them once each, so whoever caches
+// the tessellation only redoes those. Curves can be marked dirty for other reasons too (a new
+// view), so each curve also has a stamp that only changes with its points, for caches that
+// depend on nothing else.
+class CurveDocument
+{
+public:
+	CurveDocument() : Edits(0)
+	{
+	}
+
+	void clear()
+	{
+		X.clear();
+		Y.clear();
+		First.clear();
+		Count.clear();
+		Dirty.clear();
+		DirtyList.clear();
+		Stamp.clear();
+	}
+
+	// start a new, empty curve at the end; returns its index
+	int addCurve()
+	{
+		First.push_back((int)X.size());
+		Count.push_back(0);
+		Dirty.push_back(0);
+		Stamp.push_back(++Edits);
+		markDirty(curves() - 1);
+		return curves() - 1;
+	}
+
+	// a whole curve from count (x, y) pairs
+	int addCurve(const float* xy, int count)
+	{
+		int curve = addCurve();
+		for (int i = 0; i < count; i++)
+			addPoint(xy[2 * i], xy[2 * i + 1]);
+		return curve;
+	}
+
+	// append a control point to the last curve
+	void addPoint(float x, float y)
+	{
+		X.push_back(x);
+		Y.push_back(y);
+		Count.back()++;
+		Stamp.back() = ++Edits;
+		markDirty(curves() - 1);
+	}
+
+	void movePoint(int point, float x, float y)
+	{
+		X[point] = x;
+		Y[point] = y;
+		int curve = curveOf(point);
+		Stamp[curve] = ++Edits;
+		markDirty(curve);
+	}
+
+	// curve the point belongs to (the last curve starting at or before it)
+	int curveOf(int point) const
+	{
+		return int(std::upper_bound(First.begin(), First.end(), point) - First.begin()) - 1;
+	}
+
+	int curves() const { return (int)First.size(); }
+	int points() const { return (int)X.size(); }
+	int first(int curve) const { return First[curve]; }
+	int count(int curve) const { return Count[curve]; }
+	const float* xs() const { return X.empty() ? NULL : &X[0]; }
+	const float* ys() const { return Y.empty() ? NULL : &Y[0]; }
+	float x(int point) const { return X[point]; }
+	float y(int point) const { return Y[point]; }
+	// changes whenever the points of the curve do, and never repeats (not even after clear()),
+	// so 0 can stand for "nothing cached yet"
+	unsigned int stamp(int curve) const { return Stamp[curve]; }
+
+	// the curves changed since the last clearDirty(), each once
+	const std::vector<int>& dirtyCurves() const { return DirtyList; }
+	void clearDirty()
+	{
+		for (size_t i = 0; i < DirtyList.size(); i++)
+			Dirty[DirtyList[i]] = 0;
+		DirtyList.clear();
+	}
+	void markDirty(int curve)
+	{
+		if (!Dirty[curve]) {
+			Dirty[curve] = 1;
+			DirtyList.push_back(curve);
+		}
+	}
+
+private:
+	std::vector<float> X, Y;
+	std::vector<int> First;
+	std::vector<int> Count;
+	std::vector<unsigned char> Dirty;
+	std::vector<int> DirtyList;
+	std::vector<unsigned int> Stamp;
+	unsigned int Edits;
+
+	CurveDocument(const CurveDocument&);
+	CurveDocument& operator=(const CurveDocument&);
+};
+#endif
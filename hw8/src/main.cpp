@@ -1,36 +1,130 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <thread>
 #include <glm\glm.hpp>
 #include <glm\gtc\matrix_transform.hpp>
 #include <glm\gtc\type_ptr.hpp>
 #include "shader_s.h"
+#include "thick_lines.h"
+#include "bezier.h"
+#include "curve_document.h"
+#include "slot_layout.h"
+#include "pick_grid.h"
+#include "arc_length.h"
+#include "stroke_builder.h"
+#include "simplify.h"
+#include "thread_pool.h"
 #include <imgui.h>
 #include <imgui_impl_glfw_gl3.h>
 using namespace std;
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void window_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow *window);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void drawBezier();
-void setPoint(int x, int y);
-float calQ(float t, int isx);
+void tessellate(int curve, vector<float>& out);
+void tessellateCurves(const vector<int>& curves, vector<vector<float> >& out);
+bool simplifies();
+float curveZoom(int curve);
+void uploadControlPoints(ThickLines& controlPolygon);
+void setPoint(double xpos, double ypos);
+void toNDC(double xpos, double ypos, float& x, float& y);
+float pixelScaleX();
+float pixelScaleY();
+void toWorld(double xpos, double ypos, float& x, float& y);
+void randomCurves(int count, int pointsEach);
+void uploadGPUCurves();
+void moveGPUPoint(int point);
+void applyDrag();
+bool usesArcLength();
+int updateMarkers(float time);
+void addStrokeSample(float x, float y);
+void uploadStrokes();
+void updateView();
+int levelOf(int curve);
 
 // settings
 const unsigned int SCR_WIDTH = 1280;
 const unsigned int SCR_HEIGHT = 720;
+// current size of the window (the units of cursor positions) and of its framebuffer (the
+// pixels tolerances and tessellation are measured in), kept by the resize callbacks;
+// pixelsChanged asks updateView() to tessellate again for the new pixel size
+int windowWidth = SCR_WIDTH, windowHeight = SCR_HEIGHT;
+int framebufferWidth = SCR_WIDTH, framebufferHeight = SCR_HEIGHT;
+bool pixelsChanged = false;
 
-// Bezier
-float vertices[4020];
+// Bezier: every curve of the document has its own range of bezierVBO (curveLayout), so a
+// drag only re-tessellates and re-uploads the curves it changed, and all of them are drawn
+// with one glMultiDrawArrays
+CurveDocument document;
+SlotLayout curveLayout;
 unsigned int bezierVBO, bezierVAO;
-int lineCount = 0;
+int steps = 2000;
+vector<vector<float> > curveVertices;
+float updateMs = 0.0f;
+// adaptive mode: the curve is flattened into a polyline that stays within flatness pixels of
+// it and drawn as GL_LINE_STRIP, instead of 2001 points
+bool isAdaptive = false;
+unsigned int curvePrimitive = GL_POINTS;
+float flatness = 0.5f;
+// constant speed: samples equally spaced along the curve instead of in t, through a table of
+// arc length per curve (arcTables, rebuilt only when the curve's points changed, which arcStamps
+// tells from document.stamp; a new view does not change them); dashed draws every other
+// step as a GL_LINES dash. Markers run along every curve at markerSpeed pixels per second
+const int ARC_SAMPLES = 128;
+vector<ArcLengthTable> arcTables;
+vector<unsigned int> arcStamps;
+bool isConstantSpeed = false;
+bool isDashed = false;
+float dashLength = 8.0f;
+bool showMarkers = false;
+float markerSpeed = 150.0f;
+unsigned int markerVBO, markerVAO;
+vector<float> markerPoints;
+// simplification: the samples of a curve are reduced with Ramer-Douglas-Peucker to within
+// simplifyTolerance pixels before upload, and drawn as a line strip. The curves of an update
+// are tessellated and simplified on several threads when there are many of them, from a pool
+// that is created once in main and kept for the whole run
+const int PARALLEL_CURVES = 64;
+ThreadPool* tessellationPool = NULL;
+bool isSimplified = false;
+float simplifyTolerance = 0.25f;
+long long rawVertices = 0, keptVertices = 0;
+float simplifyMs = 0.0f;
+// GPU mode: bezier.vert evaluates the curves itself from the control points, one instance per
+// curve, so nothing is tessellated or uploaded here and a drag only writes the moved point
+bool isGPU = false;
+unsigned int gpuXBuffer, gpuYBuffer, gpuXTexture, gpuYTexture;
+unsigned int gpuCurveVBO, gpuCurveVAO;
+int gpuCurves = 0;
+vector<int> gpuCurveRanges;
+// distance field strokes (GPU mode): every curve is one quad over its control points, and
+// bezier_sdf.frag covers the pixels within strokeWidth / 2 of the curve, so the cost follows
+// the covered pixels instead of the samples and the stroke stays smooth at any zoom
+bool isDistanceField = false;
+float strokeWidth = 3.0f;
 
-// four points
-float points[8];
-int pcount = 0;
+// control points: the curve still being placed takes pointsPerCurve clicks
+int pointsPerCurve = 4;
+int placingCurve = -1;
 unsigned int fourVBO = 0, fourVAO = 0;
+int fourCapacity = 0;
+bool controlsDirty = false;
+vector<float> controlPoints;
+vector<float> controlSegments;
 int nearstPoint;
+// picking: a click grabs the nearest control point within pickRadius pixels, found through a
+// grid that follows every added and moved point
+PickGrid pickIndex;
+float pickRadius = 12.0f;
 
 // pos of mouse
 float lastX = (float)SCR_WIDTH / 2.0;
@@ -38,6 +132,43 @@ float lastY = (float)SCR_HEIGHT / 2.0;
 bool firstMouse = true;
 
 bool isMouseLeftPress = false;
+// dragging: mouse_callback only records the latest cursor position, and applyDrag() moves the
+// point and updates the curve once per frame, however many events came in since
+bool dragPending = false;
+long long dragEvents = 0;
+long long dragUpdates = 0;
+
+// freehand strokes: while the button is down every raw cursor sample goes to strokeBuilder,
+// which appends the vertices of each span it completes to strokeVertices. Strokes are only
+// ever extended at the end, so uploadStrokes() appends the vertices not yet in strokeVBO
+// (from strokeUploaded on) with one glBufferSubData per frame
+bool isFreehand = false;
+bool isStroking = false;
+StrokeBuilder strokeBuilder;
+vector<float> strokeVertices;
+vector<int> strokeFirst, strokeCount;
+int strokeUploaded = 0;
+int strokeCapacity = 0;
+int strokeUploadBytes = 0;
+long long strokeSamples = 0;
+unsigned int strokeVBO, strokeVAO;
+
+// view: the document is kept in world coordinates (the NDC of the unzoomed window) and drawn
+// at (p - viewCenter) * viewZoom. The scroll wheel zooms around the cursor, the right button
+// pans; updateView() handles the changes once per frame
+float viewZoom = 1.0f;
+float viewCenterX = 0.0f, viewCenterY = 0.0f;
+bool viewChanged = false;
+bool isPanning = false;
+// view-dependent tessellation: every curve has a level worked out from the view (levelOf),
+// and is only tessellated again when its level changes. Curves whose control points are all
+// off screen get CULLED and no vertices; the others get a zoom bucket (adaptive flattening and
+// dashes, whose pixel sizes scale with the zoom) or a bucket of their control polygon's length
+// on screen (samples per curve)
+const int CULLED = -1;
+const int ZOOM_LEVEL = 1000;    // + twice log2 of the zoom, a few dozen either way
+bool isViewDependent = true;
+vector<int> curveLevels;
 
 // timing
 float deltaTime = 0.0f;
@@ -71,9 +202,13 @@ int main() {
 
 	// set callback
 	glfwMakeContextCurrent(window);
+	glfwGetWindowSize(window, &windowWidth, &windowHeight);
+	glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
 	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+	glfwSetWindowSizeCallback(window, window_size_callback);
 	glfwSetCursorPosCallback(window, mouse_callback);
 	glfwSetMouseButtonCallback(window, mouse_button_callback);
+	glfwSetScrollCallback(window, scroll_callback);
 
 	// glad: load all OpenGL function pointers
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
@@ -82,15 +217,16 @@ int main() {
 	}
 
 	Shader bezier("points.vert", "points.frag");
+	Shader bezierGPU("bezier.vert", "points.frag");
+	Shader bezierSDF("bezier_sdf.vert", "bezier_sdf.frag");
 	// different color
 	Shader fourPoints("points.vert", "points2.frag");
 
-	// four points
+	// control points of all curves
 	glGenVertexArrays(1, &fourVAO);
 	glGenBuffers(1, &fourVBO);
 	glBindVertexArray(fourVAO);
 	glBindBuffer(GL_ARRAY_BUFFER, fourVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 2 * pcount, points, GL_STATIC_DRAW);
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
 	glEnableVertexAttribArray(0);
 	fourPoints.use();
@@ -104,8 +240,61 @@ int main() {
 	glEnableVertexAttribArray(0);
 	bezier.use();
 
+	// GPU mode: control points as buffer textures, (first, count) of every curve per instance
+	glGenBuffers(1, &gpuXBuffer);
+	glGenBuffers(1, &gpuYBuffer);
+	glGenTextures(1, &gpuXTexture);
+	glGenTextures(1, &gpuYTexture);
+	glBindBuffer(GL_TEXTURE_BUFFER, gpuXBuffer);
+	glBindTexture(GL_TEXTURE_BUFFER, gpuXTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R32F, gpuXBuffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, gpuYBuffer);
+	glBindTexture(GL_TEXTURE_BUFFER, gpuYTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R32F, gpuYBuffer);
+	glGenVertexArrays(1, &gpuCurveVAO);
+	glGenBuffers(1, &gpuCurveVBO);
+	glBindVertexArray(gpuCurveVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, gpuCurveVBO);
+	glVertexAttribIPointer(0, 2, GL_INT, 2 * sizeof(int), (void*)0);
+	glVertexAttribDivisor(0, 1);
+	glEnableVertexAttribArray(0);
+	bezierGPU.use();
+	bezierGPU.setInt("pointsX", 0);
+	bezierGPU.setInt("pointsY", 1);
+	bezierSDF.use();
+	bezierSDF.setInt("pointsX", 0);
+	bezierSDF.setInt("pointsY", 1);
+
+	// markers: one point per curve, rewritten every frame
+	glGenVertexArrays(1, &markerVAO);
+	glGenBuffers(1, &markerVBO);
+	glBindVertexArray(markerVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, markerVBO);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	// freehand strokes, appended to as they are drawn
+	glGenVertexArrays(1, &strokeVAO);
+	glGenBuffers(1, &strokeVBO);
+	glBindVertexArray(strokeVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, strokeVBO);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	strokeBuilder.setParameters(0.5f, 2.0f, pixelScaleX(), pixelScaleY());
+
+	// tessellation workers, started once instead of for every large update
+	ThreadPool pool;
+	tessellationPool = &pool;
+
 	float color[3] = { 1.0f, 0.5f, 0.2f };
 
+	// control polygon: glLineWidth(2.0f) is not guaranteed in a core profile, so it is drawn
+	// as quads, in the color of points2.frag
+	ThickLines controlPolygon;
+	const float polygonColor[4] = { 0.2f, 0.3f, 0.4f, 1.0f };
+
+	int randomCount = 1000;
+
 	// render loop
 	while (!glfwWindowShouldClose(window)) {
 		float currentFrame = glfwGetTime();
@@ -115,28 +304,179 @@ int main() {
 		//input
 		processInput(window);
 
+		// at most one curve update per frame, with the latest position
+		applyDrag();
+		updateView();
+		uploadStrokes();
+
 		//render
 		glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT);
 
-		bezier.use();
+		// world to NDC for every shader
+		glm::vec4 view(viewZoom, viewZoom, -viewCenterX * viewZoom, -viewCenterY * viewZoom);
+		controlPolygon.setTransform(view.x, view.y, view.z, view.w);
+
 		glPointSize(4.0f);
-		glBindVertexArray(bezierVAO);
-		bezier.setVec3("ourColor", glm::vec3(color[0], color[1], color[2]));
-		glDrawArrays(GL_POINTS, 0, lineCount);
+		if (isGPU) {
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_BUFFER, gpuXTexture);
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_BUFFER, gpuYTexture);
+			glActiveTexture(GL_TEXTURE0);
+			glBindVertexArray(gpuCurveVAO);
+			if (isDistanceField) {
+				int viewport[4];
+				glGetIntegerv(GL_VIEWPORT, viewport);
+				bezierSDF.use();
+				bezierSDF.setVec4("view", view);
+				bezierSDF.setVec2("viewport", float(viewport[2]), float(viewport[3]));
+				bezierSDF.setFloat("halfWidth", strokeWidth / 2);
+				bezierSDF.setVec3("ourColor", glm::vec3(color[0], color[1], color[2]));
+				glEnable(GL_BLEND);
+				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+				if (gpuCurves > 0)
+					glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, gpuCurves);
+				glDisable(GL_BLEND);
+			}
+			else {
+				bezierGPU.use();
+				bezierGPU.setVec4("view", view);
+				bezierGPU.setVec3("ourColor", glm::vec3(color[0], color[1], color[2]));
+				bezierGPU.setInt("steps", steps);
+				if (gpuCurves > 0)
+					glDrawArraysInstanced(GL_POINTS, 0, steps + 1, gpuCurves);
+			}
+		}
+		else {
+			bezier.use();
+			bezier.setVec4("view", view);
+			glBindVertexArray(bezierVAO);
+			bezier.setVec3("ourColor", glm::vec3(color[0], color[1], color[2]));
+			if (curveLayout.slots() > 0)
+				glMultiDrawArrays(curvePrimitive, curveLayout.firsts(), curveLayout.counts(), curveLayout.slots());
+		}
+		if (!strokeFirst.empty()) {
+			bezier.use();
+			bezier.setVec4("view", view);
+			bezier.setVec3("ourColor", glm::vec3(color[0], color[1], color[2]));
+			glBindVertexArray(strokeVAO);
+			glMultiDrawArrays(GL_LINE_STRIP, &strokeFirst[0], &strokeCount[0], (int)strokeFirst.size());
+		}
+		if (showMarkers && usesArcLength()) {
+			int markers = updateMarkers(currentFrame);
+			fourPoints.use();
+			fourPoints.setVec4("view", view);
+			glBindVertexArray(markerVAO);
+			glPointSize(8.0f);
+			glDrawArrays(GL_POINTS, 0, markers);
+		}
 
-		// four points
+		// control points and control polygons
+		if (controlsDirty)
+			uploadControlPoints(controlPolygon);
 		fourPoints.use();
+		fourPoints.setVec4("view", view);
 		glBindVertexArray(fourVAO);
 		glPointSize(3.0f);
-		glDrawArrays(GL_POINTS, 0, pcount);
-		glLineWidth(2.0f);
-		glDrawArrays(GL_LINE_STRIP, 0, pcount);
+		glDrawArrays(GL_POINTS, 0, document.points());
+		controlPolygon.draw(2.0f, ThickLines::JOIN_ROUND, polygonColor);
 
 		// ImGui
 		ImGui_ImplGlfwGL3_NewFrame();
 		ImGui::Begin("Set Color");
 		ImGui::ColorEdit3("Bezier Curve", color);
+		bool changed = ImGui::Checkbox("Evaluate on the GPU", &isGPU);
+		if (isGPU)
+			ImGui::Checkbox("Distance field strokes", &isDistanceField);
+		if (!isGPU)
+			changed |= ImGui::Checkbox("Adaptive (line strip)", &isAdaptive);
+		if (!isGPU && !isAdaptive) {
+			changed |= ImGui::Checkbox("Constant speed (arc length)", &isConstantSpeed);
+			if (isConstantSpeed)
+				changed |= ImGui::Checkbox("Dashed", &isDashed);
+		}
+		if (isAdaptive && !isGPU)
+			changed |= ImGui::SliderFloat("flatness (pixels)", &flatness, 0.05f, 10.0f);
+		else if (isConstantSpeed && isDashed && !isGPU)
+			changed |= ImGui::SliderFloat("dash length (pixels)", &dashLength, 2.0f, 40.0f);
+		else if (isGPU && isDistanceField)
+			ImGui::SliderFloat("stroke width (pixels)", &strokeWidth, 1.0f, 20.0f);
+		else
+			changed |= ImGui::SliderInt("samples per curve", &steps, 10, 2000);
+		if (!isGPU && !isAdaptive && !(isConstantSpeed && isDashed)) {
+			changed |= ImGui::Checkbox("Simplify (RDP)", &isSimplified);
+			if (isSimplified)
+				changed |= ImGui::SliderFloat("simplify tolerance (pixels)", &simplifyTolerance, 0.05f, 5.0f);
+		}
+		if (!isGPU)
+			changed |= ImGui::Checkbox("View-dependent tessellation", &isViewDependent);
+		if (!isGPU) {
+			changed |= ImGui::Checkbox("Markers", &showMarkers);
+			if (showMarkers)
+				ImGui::SliderFloat("marker speed (pixels/s)", &markerSpeed, 10.0f, 1000.0f);
+		}
+		if (changed) {
+			for (int i = 0; i < document.curves(); i++)
+				document.markDirty(i);
+			drawBezier();
+		}
+		if (ImGui::Button("Reset view")) {
+			viewZoom = 1.0f;
+			viewCenterX = viewCenterY = 0.0f;
+			viewChanged = true;
+		}
+		ImGui::Checkbox("Freehand strokes", &isFreehand);
+		ImGui::SliderInt("control points per curve", &pointsPerCurve, 2, 16);
+		if (ImGui::Button("New curve")) {
+			// a curve left with fewer points is finished as it is
+			int finished = placingCurve;
+			if (finished < 0 || document.count(finished) > 0) {
+				placingCurve = document.addCurve();
+				if (finished >= 0)
+					document.markDirty(finished);
+				drawBezier();
+			}
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Clear")) {
+			document.clear();
+			curveLevels.clear();
+			pickIndex.build(NULL, NULL, 0);
+			curveLayout.resize(0);
+			gpuCurves = 0;
+			placingCurve = -1;
+			controlsDirty = true;
+			strokeVertices.clear();
+			strokeFirst.clear();
+			strokeCount.clear();
+			strokeUploaded = 0;
+			isStroking = false;
+		}
+		ImGui::SliderFloat("pick radius (pixels)", &pickRadius, 2.0f, 40.0f);
+		ImGui::SliderInt("random curves", &randomCount, 100, 20000);
+		if (ImGui::Button("Add random curves")) {
+			randomCurves(randomCount, pointsPerCurve);
+			drawBezier();
+		}
+		long long curveVertices = 0;
+		for (int i = 0; i < curveLayout.slots(); i++)
+			curveVertices += curveLayout.count(i);
+		if (isGPU)
+			curveVertices = (long long)gpuCurves * (isDistanceField ? 4 : steps + 1);
+		ImGui::Text("curves: %d, control points: %d", document.curves(), document.points());
+		ImGui::Text("curve vertices: %lld, last update %.2f ms", curveVertices, updateMs);
+		int culled = 0;
+		for (size_t i = 0; i < curveLevels.size(); i++)
+			culled += curveLevels[i] == CULLED;
+		ImGui::Text("view: zoom %.2f, center (%.2f, %.2f), %d curves off screen", viewZoom, viewCenterX, viewCenterY,
+			isViewDependent && !isGPU ? culled : 0);
+		if (simplifies() && !isGPU)
+			ImGui::Text("simplified: %lld -> %lld vertices (%.1f%%), %.2f ms over all threads", rawVertices, keptVertices,
+				rawVertices > 0 ? 100.0 * keptVertices / rawVertices : 100.0, simplifyMs);
+		ImGui::Text("drag: %lld mouse events, %lld curve updates", dragEvents, dragUpdates);
+		ImGui::Text("strokes: %d, %lld samples, %d vertices, last upload %d bytes", (int)strokeFirst.size(), strokeSamples,
+			(int)strokeVertices.size() / 2, strokeUploadBytes);
 		ImGui::End();
 		ImGui::Render();
 		ImGui_ImplGlfwGL3_RenderDrawData(ImGui::GetDrawData());
@@ -150,6 +490,17 @@ int main() {
 	glDeleteVertexArrays(1, &bezierVAO);
 	glDeleteBuffers(1, &fourVBO);
 	glDeleteBuffers(1, &bezierVBO);
+	glDeleteVertexArrays(1, &markerVAO);
+	glDeleteBuffers(1, &markerVBO);
+	glDeleteVertexArrays(1, &strokeVAO);
+	glDeleteBuffers(1, &strokeVBO);
+	glDeleteVertexArrays(1, &gpuCurveVAO);
+	glDeleteBuffers(1, &gpuCurveVBO);
+	glDeleteTextures(1, &gpuXTexture);
+	glDeleteTextures(1, &gpuYTexture);
+	glDeleteBuffers(1, &gpuXBuffer);
+	glDeleteBuffers(1, &gpuYBuffer);
+	controlPolygon.release();
 	ImGui_ImplGlfwGL3_Shutdown();
 	ImGui::DestroyContext();
 	glfwTerminate();
@@ -167,55 +518,94 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
 	// make sure the viewport matches the new window dimensions; note that width and 
 	// height will be significantly larger than specified on retina displays.
 	glViewport(0, 0, width, height);
+	// a minimized window has an empty framebuffer; keep the last size for the pixel scale
+	if (width <= 0 || height <= 0 || (width == framebufferWidth && height == framebufferHeight))
+		return;
+	framebufferWidth = width;
+	framebufferHeight = height;
+	pixelsChanged = true;
+}
+
+// cursor positions are in window coordinates, which differ from the framebuffer's on retina displays
+void window_size_callback(GLFWwindow* window, int width, int height) {
+	if (width <= 0 || height <= 0)
+		return;
+	windowWidth = width;
+	windowHeight = height;
 }
 
 void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
+	// panning: the world point under the cursor follows it
+	if (isPanning) {
+		viewCenterX -= float(xpos - lastX) / (float(windowWidth) / 2) / viewZoom;
+		viewCenterY += float(ypos - lastY) / (float(windowHeight) / 2) / viewZoom;
+		viewChanged = true;
+	}
 	lastX = xpos;
 	lastY = ypos;
 
+	// strokes keep every sample, their per-sample cost is constant
+	if (isStroking) {
+		float x, y;
+		toWorld(lastX, lastY, x, y);
+		addStrokeSample(x, y);
+	}
 	if (isMouseLeftPress) {
-		// λת
-		float x = float(lastX), y = float(SCR_HEIGHT - lastY);
-		float flnum = x - (float(SCR_WIDTH)) / 2;
-		x = flnum / (float(SCR_WIDTH) / 2);
-		flnum = y - (float(SCR_HEIGHT)) / 2;
-		y = flnum / (float(SCR_HEIGHT) / 2);
-		points[2 * nearstPoint] = x;
-		points[2 * nearstPoint + 1] = y;
-		glBindBuffer(GL_ARRAY_BUFFER, fourVBO);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 2 * pcount, points, GL_STATIC_DRAW);
-		drawBezier();
+		dragPending = true;
+		dragEvents++;
 	}
 }
 
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
+	// this callback replaces ImGui's, so pass the event on; a press over the ImGui window is
+	// its own (no point, drag, stroke or pan), releases always end what was started
+	ImGui_ImplGlfwGL3_MouseButtonCallback(window, button, action, mods);
+	if (action == GLFW_PRESS && ImGui::GetIO().WantCaptureMouse)
+		return;
+	if (button == GLFW_MOUSE_BUTTON_RIGHT) {
+		isPanning = action == GLFW_PRESS;
+		return;
+	}
+	if (action == GLFW_PRESS && button == GLFW_MOUSE_BUTTON_LEFT && isFreehand) {
+		float x, y;
+		toWorld(lastX, lastY, x, y);
+		// tolerances stay in screen pixels at the current zoom
+		strokeBuilder.setParameters(0.5f, 2.0f, pixelScaleX() * viewZoom, pixelScaleY() * viewZoom);
+		isStroking = true;
+		strokeFirst.push_back((int)strokeVertices.size() / 2);
+		strokeCount.push_back(0);
+		strokeBuilder.begin(x, y, strokeVertices);
+		strokeCount.back() = (int)strokeVertices.size() / 2 - strokeFirst.back();
+		strokeSamples++;
+		return;
+	}
+	if (action == GLFW_RELEASE && isStroking) {
+		isStroking = false;
+		strokeBuilder.end(strokeVertices);
+		strokeCount.back() = (int)strokeVertices.size() / 2 - strokeFirst.back();
+		return;
+	}
 	if (action == GLFW_PRESS) {
 		if (button == GLFW_MOUSE_BUTTON_LEFT) {
-			if (pcount < 4) {
-				setPoint(lastX, SCR_HEIGHT - lastY);
-				glBindBuffer(GL_ARRAY_BUFFER, fourVBO);
-				glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 2 * pcount, points, GL_STATIC_DRAW);
-				if (pcount == 4)
+			// the first click of an empty document starts a curve
+			if (placingCurve < 0 && document.points() == 0)
+				placingCurve = document.addCurve();
+			if (placingCurve >= 0) {
+				setPoint(lastX, lastY);
+				if (document.count(placingCurve) >= pointsPerCurve) {
+					placingCurve = -1;
 					drawBezier();
+				}
 			}
 			else {
-				isMouseLeftPress = true;
-				cout << "is mouse left button press = true" << endl;
-				// λת
-				float x = float(lastX), y = float(SCR_HEIGHT - lastY);
-				float flnum = x - (float(SCR_WIDTH)) / 2;
-				x = flnum / (float(SCR_WIDTH) / 2);
-				flnum = y - (float(SCR_HEIGHT)) / 2;
-				y = flnum / (float(SCR_HEIGHT) / 2);
-				// 
-				nearstPoint = 0;
-				float mindistance = pow(x - points[0], 2) + pow(y - points[1], 2);
-				for (int i = 1; i < 4; i++) {
-					float d = pow(x - points[2 * i], 2) + pow(y - points[2 * i + 1], 2);
-					if (d < mindistance) {
-						nearstPoint = i;
-						mindistance = d;
-					}
+				float x, y;
+				toWorld(lastX, lastY, x, y);
+				// 㣨ʰȡ뾶ڣû϶
+				nearstPoint = pickIndex.nearest(x, y, pickRadius / pixelScaleX() / viewZoom,
+					pickRadius / pixelScaleY() / viewZoom);
+				if (nearstPoint >= 0) {
+					isMouseLeftPress = true;
+					cout << "is mouse left button press = true" << endl;
 				}
 			}
 		}
@@ -226,32 +616,440 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
 	}
 }
 
+// ϸĵиĶߣֻϴbezierVBOеһΣ
+// ĳ߷Ųʱһ»壬ûĶGPUϴӾɻ帴ƹȥ
 void drawBezier() {
-	float t = 0.0;
-	for (int i = 0; i < 2000; i++) {
-		vertices[2 * i] = calQ(t, 0);
-		vertices[2 * i + 1] = calQ(t, 1);
-		t += 0.0005;
+	const vector<int>& dirty = document.dirtyCurves();
+	if (dirty.empty())
+		return;
+	double start = glfwGetTime();
+	controlsDirty = true;
+	if (isGPU) {
+		uploadGPUCurves();
+		document.clearDirty();
+		updateMs = float((glfwGetTime() - start) * 1000.0);
+		return;
 	}
-	vertices[4000] = points[6];
-	vertices[4001] = points[7];
-	lineCount = 2001;
-	glBindBuffer(GL_ARRAY_BUFFER, bezierVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 2 * lineCount, vertices, GL_STATIC_DRAW);
+	if (isAdaptive)
+		curvePrimitive = GL_LINE_STRIP;
+	else if (isConstantSpeed && isDashed)
+		curvePrimitive = GL_LINES;
+	else if (isSimplified)
+		curvePrimitive = GL_LINE_STRIP;
+	else
+		curvePrimitive = GL_POINTS;
+	while (curveLayout.slots() < document.curves())
+		curveLayout.addSlot();
+	// the level of each changed curve for the current view
+	curveLevels.resize(document.curves(), CULLED);
+	for (size_t i = 0; i < dirty.size(); i++)
+		curveLevels[dirty[i]] = levelOf(dirty[i]);
+	// arc length tables first, the constant speed tessellation reads them
+	if (usesArcLength()) {
+		arcTables.resize(document.curves());
+		arcStamps.resize(document.curves(), 0);
+		for (size_t i = 0; i < dirty.size(); i++) {
+			int c = dirty[i];
+			if (arcStamps[c] == document.stamp(c))
+				continue;
+			arcTables[c].build(document.xs() + document.first(c), document.ys() + document.first(c), document.count(c),
+				ARC_SAMPLES, pixelScaleX(), pixelScaleY());
+			arcStamps[c] = document.stamp(c);
+		}
+	}
+
+	const size_t vertexBytes = 2 * sizeof(float);
+	tessellateCurves(dirty, curveVertices);
+	bool relayout = false;
+	for (size_t i = 0; i < dirty.size(); i++)
+		relayout = relayout || !curveLayout.fits(dirty[i], (int)curveVertices[i].size() / 2);
+	if (!relayout) {
+		glBindBuffer(GL_ARRAY_BUFFER, bezierVBO);
+		for (size_t i = 0; i < dirty.size(); i++) {
+			int count = (int)curveVertices[i].size() / 2;
+			curveLayout.setCount(dirty[i], count);
+			if (count > 0)
+				glBufferSubData(GL_ARRAY_BUFFER, curveLayout.first(dirty[i]) * vertexBytes, count * vertexBytes, &curveVertices[i][0]);
+		}
+	}
+	else {
+		// every curve moves to a new buffer: the unchanged ones are copied there on the GPU from
+		// where they were, only the changed ones are uploaded
+		vector<int> oldFirst(curveLayout.firsts(), curveLayout.firsts() + curveLayout.slots());
+		vector<bool> changed(curveLayout.slots(), false);
+		for (size_t i = 0; i < dirty.size(); i++) {
+			curveLayout.setCount(dirty[i], (int)curveVertices[i].size() / 2);
+			changed[dirty[i]] = true;
+		}
+		unsigned int buffer;
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, curveLayout.totalCapacity() * vertexBytes, NULL, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_COPY_READ_BUFFER, bezierVBO);
+		for (int c = 0; c < curveLayout.slots(); c++)
+			if (!changed[c] && curveLayout.count(c) > 0)
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, oldFirst[c] * vertexBytes,
+					curveLayout.first(c) * vertexBytes, curveLayout.count(c) * vertexBytes);
+		for (size_t i = 0; i < dirty.size(); i++)
+			if (!curveVertices[i].empty())
+				glBufferSubData(GL_COPY_WRITE_BUFFER, curveLayout.first(dirty[i]) * vertexBytes,
+					curveVertices[i].size() * sizeof(float), &curveVertices[i][0]);
+		glDeleteBuffers(1, &bezierVBO);
+		bezierVBO = buffer;
+		glBindVertexArray(bezierVAO);
+		glBindBuffer(GL_ARRAY_BUFFER, bezierVBO);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+		glBindVertexArray(0);
+	}
+	document.clearDirty();
+	updateMs = float((glfwGetTime() - start) * 1000.0);
+}
+
+// ϸ֣Ҫʱٻcurvesеÿߣout[i]߶ʱָ̳߳أ
+// kݴ±i % threads == kЩߡͬʱͳƻǰĶͻõʱ
+void tessellateCurves(const vector<int>& curves, vector<vector<float> >& out) {
+	int n = (int)curves.size();
+	if ((int)out.size() < n)
+		out.resize(n);
+	int threads = 1;
+	if (n >= PARALLEL_CURVES && tessellationPool != NULL)
+		threads = max(1, min((int)tessellationPool->size(), n / (PARALLEL_CURVES / 2)));
+	bool simplify = simplifies();
+	vector<long long> raw(threads, 0), kept(threads, 0);
+	vector<double> seconds(threads, 0.0);
+	auto work = [&](int k) {
+		vector<float> samples;
+		for (int i = k; i < n; i += threads) {
+			if (!simplify) {
+				tessellate(curves[i], out[i]);
+				continue;
+			}
+			tessellate(curves[i], samples);
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			// the tolerance is in the same pixels the curve was tessellated for
+			float zoom = curveZoom(curves[i]);
+			simplifyPolyline(samples.empty() ? NULL : &samples[0], (int)samples.size() / 2, simplifyTolerance,
+				pixelScaleX() * zoom, pixelScaleY() * zoom, out[i]);
+			seconds[k] += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+			raw[k] += samples.size() / 2;
+			kept[k] += out[i].size() / 2;
+		}
+	};
+	if (threads > 1)
+		tessellationPool->run(threads, work);
+	else
+		work(0);
+	if (simplify) {
+		rawVertices = keptVertices = 0;
+		simplifyMs = 0.0f;
+		for (int k = 0; k < threads; k++) {
+			rawVertices += raw[k];
+			keptVertices += kept[k];
+			simplifyMs += float(seconds[k] * 1000.0);
+		}
+	}
+}
+
+// ϸһʱĸűأŵλõλӦıƶγȵλ
+// õǰţǰѡģӽʱʼӽǣ1
+float curveZoom(int curve) {
+	if (!isViewDependent)
+		return 1.0f;
+	int level = curveLevels[curve];
+	if (level >= ZOOM_LEVEL / 2)
+		return pow(2.0f, (level - ZOOM_LEVEL) / 2.0f);
+	return viewZoom;
 }
 
-void setPoint(int x, int y) {
-	float flnum = x - (float(SCR_WIDTH)) / 2;
-	points[2 * pcount] = flnum / (float(SCR_WIDTH) / 2);
-	//vertices[2 * pcount] = points[2 * pcount];
-	flnum = y - (float(SCR_HEIGHT)) / 2;
-	points[2 * pcount + 1] = flnum / (float(SCR_HEIGHT) / 2);
-	//points[2 * pcount + 1] = vertices[2 * pcount + 1];
-	pcount++;
+// Ƿ񻯼ӦϸֱѾȡ㣬ҪȾĲ
+bool simplifies() {
+	return isSimplified && !isAdaptive && !(isConstantSpeed && isDashed);
 }
 
-float calQ(float t, int isx) {
-	float result = pow(1 - t, 3) * points[isx + 0] + 3 * t * pow(1 - t, 2) * points[isx + 2];
-	result += 3 * t * t * (1 - t) * points[isx + 4] + pow(t, 3) * points[isx + 6];
-	return result;
-}
\ No newline at end of file
+// һߵĶ㣺Ӧģʽ°ƽֱϸֳߣȡsteps + 1ȵtڷſƵ߲
+void tessellate(int curve, vector<float>& out) {
+	int count = document.count(curve);
+	if (count == 0 || curve == placingCurve) {
+		out.clear();
+		return;
+	}
+	// ӽأĻ߲ŵλӦű
+	// ƶγȵλÿһsteps
+	int level = isViewDependent ? curveLevels[curve] : 0;
+	if (level == CULLED) {
+		out.clear();
+		return;
+	}
+	float zoom = curveZoom(curve);
+	int samples = steps;
+	if (level > 0 && level < ZOOM_LEVEL / 2)
+		samples = max(8, min(steps, 1 << (level - 1)));
+	const float* x = document.xs() + document.first(curve);
+	const float* y = document.ys() + document.first(curve);
+	if (isAdaptive) {
+		flattenBezier(x, y, count, flatness, pixelScaleX() * zoom, pixelScaleY() * zoom, out);
+	}
+	else if (isConstantSpeed) {
+		// equal steps of arc length; a dash and a gap are one step each
+		const ArcLengthTable& table = arcTables[curve];
+		int segments = samples;
+		if (isDashed)
+			segments = max(1, int(table.length() * zoom / dashLength));
+		out.resize(2 * (segments + 1));
+		for (int i = 0; i <= segments; i++) {
+			float t = table.parameterAt(table.length() * i / segments);
+			bezierPoint(x, y, count, t, out[2 * i], out[2 * i + 1]);
+		}
+	}
+	else {
+		out.resize(2 * (samples + 1));
+		evalBezier(x, y, count, samples, &out[0]);
+	}
+}
+
+// ϴпƵ㣬ԼÿߵĿƶΣڿƵ֮߶Σ
+void uploadControlPoints(ThickLines& controlPolygon) {
+	int n = document.points();
+	controlPoints.resize(2 * n);
+	for (int i = 0; i < n; i++) {
+		controlPoints[2 * i] = document.x(i);
+		controlPoints[2 * i + 1] = document.y(i);
+	}
+	// a drag keeps the number of points, so the buffer is only reallocated when it grows
+	glBindBuffer(GL_ARRAY_BUFFER, fourVBO);
+	if (n > fourCapacity) {
+		glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 2 * n, &controlPoints[0], GL_DYNAMIC_DRAW);
+		fourCapacity = n;
+	}
+	else if (n > 0)
+		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float) * 2 * n, &controlPoints[0]);
+
+	controlSegments.clear();
+	for (int c = 0; c < document.curves(); c++) {
+		int first = document.first(c);
+		for (int i = first; i + 1 < first + document.count(c); i++) {
+			controlSegments.push_back(document.x(i));
+			controlSegments.push_back(document.y(i));
+			controlSegments.push_back(document.x(i + 1));
+			controlSegments.push_back(document.y(i + 1));
+		}
+	}
+	controlPolygon.setSegments(controlSegments.empty() ? NULL : &controlSegments[0], (int)controlSegments.size() / 4);
+	controlsDirty = false;
+}
+
+void setPoint(double xpos, double ypos) {
+	float px, py;
+	toWorld(xpos, ypos, px, py);
+	document.addPoint(px, py);
+	pickIndex.add(document.points() - 1, px, py);
+	controlsDirty = true;
+}
+
+// λת꣨y£תNDCǰĴڴС
+void toNDC(double xpos, double ypos, float& x, float& y) {
+	x = (float(xpos) - float(windowWidth) / 2) / (float(windowWidth) / 2);
+	y = (float(windowHeight - ypos) - float(windowHeight) / 2) / (float(windowHeight) / 2);
+}
+
+// űΪ1ʱһλӦ֡سȶ
+float pixelScaleX() {
+	return float(framebufferWidth) / 2;
+}
+float pixelScaleY() {
+	return float(framebufferHeight) / 2;
+}
+
+// countߣÿpointsEachƵ㣬ֲڴеһСΧ
+void randomCurves(int count, int pointsEach) {
+	if (placingCurve >= 0)
+		document.markDirty(placingCurve);
+	placingCurve = -1;
+	for (int i = 0; i < count; i++) {
+		float cx = rand() / float(RAND_MAX) * 1.8f - 0.9f;
+		float cy = rand() / float(RAND_MAX) * 1.8f - 0.9f;
+		document.addCurve();
+		for (int j = 0; j < pointsEach; j++)
+			document.addPoint(cx + rand() / float(RAND_MAX) * 0.2f - 0.1f, cy + rand() / float(RAND_MAX) * 0.2f - 0.1f);
+	}
+	pickIndex.build(document.xs(), document.ys(), document.points());
+	controlsDirty = true;
+}
+
+// GPUģʽϴȫƵ㣨xyһÿߵ(first, count)
+// ڷſƵcountΪ0
+void uploadGPUCurves() {
+	int n = document.points();
+	glBindBuffer(GL_TEXTURE_BUFFER, gpuXBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, sizeof(float) * n, document.xs(), GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, gpuYBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, sizeof(float) * n, document.ys(), GL_DYNAMIC_DRAW);
+
+	gpuCurves = document.curves();
+	gpuCurveRanges.resize(2 * gpuCurves);
+	for (int c = 0; c < gpuCurves; c++) {
+		gpuCurveRanges[2 * c] = document.first(c);
+		gpuCurveRanges[2 * c + 1] = c == placingCurve ? 0 : document.count(c);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, gpuCurveVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(int) * gpuCurveRanges.size(), gpuCurveRanges.empty() ? NULL : &gpuCurveRanges[0], GL_DYNAMIC_DRAW);
+}
+
+// GPUģʽ϶ֻд϶ǸƵ㣨xyһfloatɫ¼
+void moveGPUPoint(int point) {
+	double start = glfwGetTime();
+	float x = document.x(point), y = document.y(point);
+	glBindBuffer(GL_TEXTURE_BUFFER, gpuXBuffer);
+	glBufferSubData(GL_TEXTURE_BUFFER, sizeof(float) * point, sizeof(float), &x);
+	glBindBuffer(GL_TEXTURE_BUFFER, gpuYBuffer);
+	glBufferSubData(GL_TEXTURE_BUFFER, sizeof(float) * point, sizeof(float), &y);
+	// the CPU tessellation is redone for every curve when GPU mode is switched off
+	document.clearDirty();
+	controlsDirty = true;
+	updateMs = float((glfwGetTime() - start) * 1000.0);
+}
+
+// ϶еĿƵƵ¼λòߣÿ֡ڻǰһΣ
+// ֮֡Ķ¼ֻһ
+void applyDrag() {
+	if (!dragPending)
+		return;
+	dragPending = false;
+	float x, y;
+	toWorld(lastX, lastY, x, y);
+	document.movePoint(nearstPoint, x, y);
+	pickIndex.move(nearstPoint, x, y);
+	if (isGPU)
+		moveGPUPoint(nearstPoint);
+	else
+		drawBezier();
+	dragUpdates++;
+}
+
+// ǷҪCPUģʽµĵٲǵ
+bool usesArcLength() {
+	return !isGPU && ((isConstantSpeed && !isAdaptive) || showMarkers);
+}
+
+// ÿһǵ㣬markerSpeed/ƶյͷʼ
+// ֻ黡»ߡرǵ
+int updateMarkers(float time) {
+	markerPoints.clear();
+	int curves = min(document.curves(), (int)arcTables.size());
+	for (int c = 0; c < curves; c++) {
+		const ArcLengthTable& table = arcTables[c];
+		if (c == placingCurve || table.empty() || document.count(c) == 0)
+			continue;
+		float t = table.parameterAt(fmod(time * markerSpeed / viewZoom, max(table.length(), 1.0f)));
+		float x, y;
+		bezierPoint(document.xs() + document.first(c), document.ys() + document.first(c), document.count(c), t, x, y);
+		markerPoints.push_back(x);
+		markerPoints.push_back(y);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, markerVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * markerPoints.size(), markerPoints.empty() ? NULL : &markerPoints[0], GL_STREAM_DRAW);
+	return (int)markerPoints.size() / 2;
+}
+
+// ʻһԭʼϳһζڵǰʻĩβ
+void addStrokeSample(float x, float y) {
+	strokeBuilder.add(x, y, strokeVertices);
+	strokeCount.back() = (int)strokeVertices.size() / 2 - strokeFirst.back();
+	strokeSamples++;
+}
+
+// ѻûϴıʻӵstrokeVBOĩβŲʱݲϴ
+void uploadStrokes() {
+	int total = (int)strokeVertices.size() / 2;
+	strokeUploadBytes = 0;
+	if (total == strokeUploaded)
+		return;
+	glBindBuffer(GL_ARRAY_BUFFER, strokeVBO);
+	if (total > strokeCapacity) {
+		int capacity = strokeCapacity ? strokeCapacity : 4096;
+		while (capacity < total)
+			capacity *= 2;
+		glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 2 * capacity, NULL, GL_DYNAMIC_DRAW);
+		strokeCapacity = capacity;
+		strokeUploaded = 0;
+	}
+	strokeUploadBytes = int(sizeof(float) * 2 * (total - strokeUploaded));
+	glBufferSubData(GL_ARRAY_BUFFER, sizeof(float) * 2 * strokeUploaded, strokeUploadBytes, &strokeVertices[2 * strokeUploaded]);
+	strokeUploaded = total;
+}
+
+// ת꣨ĵпƵ꣩תNDCȥźƽ
+void toWorld(double xpos, double ypos, float& x, float& y) {
+	toNDC(xpos, ypos, x, y);
+	x = x / viewZoom + viewCenterX;
+	y = y / viewZoom + viewCenterY;
+}
+
+// ţԹΪģǰµ겻
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
+	// ͬ滻ImGuiĻصȽImGuiʱֻ
+	ImGui_ImplGlfwGL3_ScrollCallback(window, xoffset, yoffset);
+	if (ImGui::GetIO().WantCaptureMouse)
+		return;
+	float wx, wy, nx, ny;
+	toWorld(lastX, lastY, wx, wy);
+	toNDC(lastX, lastY, nx, ny);
+	viewZoom = min(4096.0f, max(1.0f / 64, viewZoom * pow(1.2f, float(yoffset))));
+	viewCenterX = wx - nx / viewZoom;
+	viewCenterY = wy - ny / viewZoom;
+	viewChanged = true;
+}
+
+// ӽǸıÿ֡һΣ¼ÿߵĵλֻϸֵλ˵ߣ
+// ֡Сʱػȫˣ߶¼
+void updateView() {
+	if (!viewChanged && !pixelsChanged)
+		return;
+	bool resized = pixelsChanged;
+	viewChanged = pixelsChanged = false;
+	if (isGPU)
+		return;
+	if (resized) {
+		arcStamps.assign(arcStamps.size(), 0);
+		for (int c = 0; c < document.curves(); c++)
+			document.markDirty(c);
+		drawBezier();
+		return;
+	}
+	if (!isViewDependent)
+		return;
+	curveLevels.resize(document.curves(), CULLED);
+	for (int c = 0; c < document.curves(); c++)
+		if (levelOf(c) != curveLevels[c])
+			document.markDirty(c);
+	drawBezier();
+}
+
+// ڵǰӽµĵλڿƵ͹ƵİΧȫĻͲCULLED
+// Ӧϸֺȡŵλÿű2ȡƶĻϳȵĵλÿһ
+int levelOf(int curve) {
+	int count = document.count(curve);
+	if (!isViewDependent || count == 0)
+		return 0;
+	const float* x = document.xs() + document.first(curve);
+	const float* y = document.ys() + document.first(curve);
+	float minX = x[0], maxX = x[0], minY = y[0], maxY = y[0];
+	for (int i = 1; i < count; i++) {
+		minX = min(minX, x[i]);
+		maxX = max(maxX, x[i]);
+		minY = min(minY, y[i]);
+		maxY = max(maxY, y[i]);
+	}
+	if ((minX - viewCenterX) * viewZoom > 1.0f || (maxX - viewCenterX) * viewZoom < -1.0f ||
+		(minY - viewCenterY) * viewZoom > 1.0f || (maxY - viewCenterY) * viewZoom < -1.0f)
+		return CULLED;
+	if (isAdaptive || (isConstantSpeed && isDashed))
+		return ZOOM_LEVEL + (int)ceil(2.0f * log2(viewZoom));
+	float length = 0.0f;
+	for (int i = 0; i + 1 < count; i++) {
+		float dx = (x[i + 1] - x[i]) * pixelScaleX() * viewZoom;
+		float dy = (y[i + 1] - y[i]) * pixelScaleY() * viewZoom;
+		length += sqrt(dx * dx + dy * dy);
+	}
+	return 1 + min(30, (int)ceil(log2(max(length, 1.0f))));
+}
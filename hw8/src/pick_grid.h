@@ -0,0 +1,192 @@
+#ifndef PICK_GRID_H
+#define PICK_GRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Uniform grid over the points (in the document's world coordinates) for picking control
+// points: nearest() only looks at the cells that overlap the pick radius, so a click costs the
+// same with a dozen points or a hundred thousand, at any pan and zoom. The grid covers the
+// bounds of the points with a quarter of their size to spare on every side; a point added or
+// moved outside them rebuilds it around the new bounds.
+//
+// Every cell keeps the positions of its points next to their indices, so a query reads each
+// cell as one contiguous run. Cells are visited in rings around the one clicked, and the
+// search stops as soon as a ring is further away than the best point so far. The grid keeps
+// its own copy of the positions. build() sizes it for the number of points (about two per
+// cell); add() and move() keep it up to date one point at a time, which is all a click or a
+// drag needs, and add() also rebuilds it when it has grown too crowded.
+class PickGrid
+{
+public:
+	PickGrid() : Columns(1), Rows(1)
+	{
+		rebuild();
+	}
+
+	void build(const float* x, const float* y, int count)
+	{
+		X.assign(x, x + count);
+		Y.assign(y, y + count);
+		rebuild();
+	}
+
+	// point must be the next index, points()
+	void add(int point, float x, float y)
+	{
+		X.push_back(x);
+		Y.push_back(y);
+		if (!covers(x, y) || (points() > 4 * Columns * Rows && Columns < MAX_SIDE)) {
+			rebuild();
+			return;
+		}
+		CellOf.push_back(cellAt(x, y));
+		Cells[CellOf[point]].push_back(entry(point));
+	}
+
+	void move(int point, float x, float y)
+	{
+		X[point] = x;
+		Y[point] = y;
+		if (!covers(x, y)) {
+			rebuild();
+			return;
+		}
+		std::vector<Entry>& from = Cells[CellOf[point]];
+		size_t i = 0;
+		while (from[i].Point != point)
+			i++;
+		int cell = cellAt(x, y);
+		if (cell == CellOf[point]) {
+			from[i] = entry(point);
+			return;
+		}
+		from[i] = from.back();
+		from.pop_back();
+		Cells[cell].push_back(entry(point));
+		CellOf[point] = cell;
+	}
+
+	// nearest point within the ellipse of radii (radiusX, radiusY) around (x, y), -1 if none;
+	// with the radii of one pick radius in pixels this is the nearest point in pixels
+	int nearest(float x, float y, float radiusX, float radiusY) const
+	{
+		int c0 = column(x - radiusX), c1 = column(x + radiusX);
+		int r0 = row(y - radiusY), r1 = row(y + radiusY);
+		int qc = column(x), qr = row(y);
+		float sx = 1.0f / radiusX, sy = 1.0f / radiusY;
+		// the smaller side of a cell, in radii: ring k is at least k - 1 of them away
+		float step = std::min(CellWidth * sx, CellHeight * sy);
+		int best = -1;
+		float bestDistance = 1.0f;
+		for (int k = 0; qc - k >= c0 || qc + k <= c1 || qr - k >= r0 || qr + k <= r1; k++) {
+			float gap = (k - 1) * step;
+			if (k > 1 && gap * gap > bestDistance)
+				break;
+			for (int r = std::max(r0, qr - k); r <= std::min(r1, qr + k); r++) {
+				// the whole row on the top and bottom of the ring, its two ends otherwise
+				if (r == qr - k || r == qr + k) {
+					for (int c = std::max(c0, qc - k); c <= std::min(c1, qc + k); c++)
+						visit(Cells[r * Columns + c], x, y, sx, sy, best, bestDistance);
+				}
+				else {
+					if (qc - k >= c0)
+						visit(Cells[r * Columns + qc - k], x, y, sx, sy, best, bestDistance);
+					if (qc + k <= c1)
+						visit(Cells[r * Columns + qc + k], x, y, sx, sy, best, bestDistance);
+				}
+			}
+		}
+		return best;
+	}
+
+	int points() const { return (int)X.size(); }
+
+private:
+	struct Entry
+	{
+		float X, Y;
+		int Point;
+	};
+
+	static const int MAX_SIDE = 256;
+	int Columns, Rows;
+	// corner and cell size of the grid
+	float MinX, MinY, CellWidth, CellHeight;
+	std::vector<float> X, Y;
+	std::vector<std::vector<Entry> > Cells;
+	std::vector<int> CellOf;
+
+	static void visit(const std::vector<Entry>& cell, float x, float y, float sx, float sy, int& best, float& bestDistance)
+	{
+		for (size_t i = 0; i < cell.size(); i++) {
+			float dx = (cell[i].X - x) * sx, dy = (cell[i].Y - y) * sy;
+			float d = dx * dx + dy * dy;
+			if (d <= bestDistance) {
+				best = cell[i].Point;
+				bestDistance = d;
+			}
+		}
+	}
+
+	// sizes the grid for the points (about two per cell) and their bounds, and fills it
+	void rebuild()
+	{
+		int count = points();
+		float x0 = -1.0f, x1 = 1.0f, y0 = -1.0f, y1 = 1.0f;
+		if (count > 0) {
+			x0 = x1 = X[0];
+			y0 = y1 = Y[0];
+			for (int i = 1; i < count; i++) {
+				x0 = std::min(x0, X[i]);
+				x1 = std::max(x1, X[i]);
+				y0 = std::min(y0, Y[i]);
+				y1 = std::max(y1, Y[i]);
+			}
+		}
+		float width = x1 > x0 ? x1 - x0 : 1.0f, height = y1 > y0 ? y1 - y0 : 1.0f;
+		int side = (int)std::sqrt(count / 2.0);
+		Columns = Rows = std::max(1, std::min(side, MAX_SIDE));
+		MinX = x0 - width / 4;
+		MinY = y0 - height / 4;
+		CellWidth = width * 1.5f / Columns;
+		CellHeight = height * 1.5f / Rows;
+		Cells.assign(Columns * Rows, std::vector<Entry>());
+		CellOf.resize(count);
+		for (int i = 0; i < count; i++) {
+			CellOf[i] = cellAt(X[i], Y[i]);
+			Cells[CellOf[i]].push_back(entry(i));
+		}
+	}
+
+	bool covers(float x, float y) const
+	{
+		return x >= MinX && x <= MinX + CellWidth * Columns && y >= MinY && y <= MinY + CellHeight * Rows;
+	}
+
+	Entry entry(int point) const
+	{
+		Entry e = { X[point], Y[point], point };
+		return e;
+	}
+
+	int column(float x) const
+	{
+		int c = (int)std::floor((x - MinX) / CellWidth);
+		return std::max(0, std::min(c, Columns - 1));
+	}
+	int row(float y) const
+	{
+		int r = (int)std::floor((y - MinY) / CellHeight);
+		return std::max(0, std::min(r, Rows - 1));
+	}
+	int cellAt(float x, float y) const
+	{
+		return row(y) * Columns + column(x);
+	}
+
+	PickGrid(const PickGrid&);
+	PickGrid& operator=(const PickGrid&);
+};
+#endif
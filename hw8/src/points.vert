@@ -2,6 +2,9 @@
 
 layout (location = 0) in vec2 aPos;
 
+// world to NDC: aPos * view.xy + view.zw
+uniform vec4 view = vec4(1.0, 1.0, 0.0, 0.0);
+
 void main() {
-	gl_Position = vec4(aPos.x, aPos.y, 0.0, 1.0);
+	gl_Position = vec4(aPos * view.xy + view.zw, 0.0, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef SIMPLIFY_H
+#define SIMPLIFY_H
+
+#include <utility>
+#include <vector>
+
+// Ramer-Douglas-Peucker simplification of a polyline (x, y interleaved): the end points are
+// kept, and in every run between two kept points the point furthest from the segment joining
+// them is kept too, as long as it is more than tolerance pixels away (measured through
+// scaleX, scaleY). Everything else is dropped, so the result stays within tolerance of the
+// input. Runs on an explicit stack, so long polylines cannot overflow the call stack.
+// The simplified polyline replaces the contents of out; returns its number of points.
+inline int simplifyPolyline(const float* xy, int count, float tolerance, float scaleX, float scaleY, std::vector<float>& out) {
+	out.clear();
+	if (count <= 2) {
+		out.assign(xy, xy + 2 * (count > 0 ? count : 0));
+		return count > 0 ? count : 0;
+	}
+	std::vector<unsigned char> keep(count, 0);
+	keep[0] = keep[count - 1] = 1;
+	std::vector<std::pair<int, int> > runs;
+	runs.push_back(std::make_pair(0, count - 1));
+	double limit = (double)tolerance * tolerance;
+	while (!runs.empty()) {
+		int a = runs.back().first, b = runs.back().second;
+		runs.pop_back();
+		double ax = xy[2 * a] * scaleX, ay = xy[2 * a + 1] * scaleY;
+		double dx = xy[2 * b] * scaleX - ax, dy = xy[2 * b + 1] * scaleY - ay;
+		double len2 = dx * dx + dy * dy;
+		int furthest = -1;
+		double worst = limit;
+		for (int i = a + 1; i < b; i++) {
+			double px = xy[2 * i] * scaleX - ax, py = xy[2 * i + 1] * scaleY - ay;
+			double t = len2 > 0.0 ? (px * dx + py * dy) / len2 : 0.0;
+			t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+			double ex = px - t * dx, ey = py - t * dy;
+			double d = ex * ex + ey * ey;
+			if (d > worst) {
+				worst = d;
+				furthest = i;
+			}
+		}
+		if (furthest < 0)
+			continue;
+		keep[furthest] = 1;
+		if (furthest - a > 1)
+			runs.push_back(std::make_pair(a, furthest));
+		if (b - furthest > 1)
+			runs.push_back(std::make_pair(furthest, b));
+	}
+	for (int i = 0; i < count; i++) {
+		if (keep[i]) {
+			out.push_back(xy[2 * i]);
+			out.push_back(xy[2 * i + 1]);
+		}
+	}
+	return (int)out.size() / 2;
+}
+#endif
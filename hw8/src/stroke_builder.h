@@ -0,0 +1,109 @@
+#ifndef STROKE_BUILDER_H
+#define STROKE_BUILDER_H
+
+#include <cmath>
+#include <vector>
+#include "bezier.h"
+
+// Freehand strokes fitted while they are drawn. Raw cursor samples go into a ring buffer that
+// only holds the last four; every new sample completes the Catmull-Rom span between the two
+// middle ones, which is turned into the equivalent cubic Bezier and flattened to within
+// tolerance pixels. Only that span's vertices are appended to the output, so each sample costs
+// the same however long the stroke already is, and the output only ever grows at its end.
+//
+// The first and last samples are repeated so the stroke runs through all of them; samples
+// closer than minDistance pixels to the previous one are dropped (they would only add noise).
+class StrokeBuilder
+{
+public:
+	StrokeBuilder() : Head(0), Count(0), Tolerance(0.25f), MinDistance(2.0f), ScaleX(1.0f), ScaleY(1.0f)
+	{
+	}
+
+	// tolerance and minDistance in pixels; the coordinates are scaled to pixels by (scaleX, scaleY)
+	void setParameters(float tolerance, float minDistance, float scaleX, float scaleY)
+	{
+		Tolerance = tolerance;
+		MinDistance = minDistance;
+		ScaleX = scaleX;
+		ScaleY = scaleY;
+	}
+
+	// starts a stroke at (x, y) and appends its first vertex to out
+	void begin(float x, float y, std::vector<float>& out)
+	{
+		Head = Count = 0;
+		push(x, y);
+		push(x, y);
+		out.push_back(x);
+		out.push_back(y);
+	}
+
+	// a raw cursor sample; appends the vertices of the span it completes to out and returns
+	// how many there were
+	int add(float x, float y, std::vector<float>& out)
+	{
+		const float* last = sample(Count - 1);
+		float dx = (x - last[0]) * ScaleX, dy = (y - last[1]) * ScaleY;
+		if (dx * dx + dy * dy < MinDistance * MinDistance)
+			return 0;
+		push(x, y);
+		return Count == 4 ? emit(out) : 0;
+	}
+
+	// ends the stroke at its last sample
+	int end(std::vector<float>& out)
+	{
+		const float* last = sample(Count - 1);
+		push(last[0], last[1]);
+		return Count == 4 ? emit(out) : 0;
+	}
+
+private:
+	float Ring[4][2];
+	int Head, Count;
+	float Tolerance, MinDistance, ScaleX, ScaleY;
+	std::vector<float> Span;
+
+	// i-th of the samples held, oldest first
+	const float* sample(int i) const
+	{
+		return Ring[(Head + i) & 3];
+	}
+
+	void push(float x, float y)
+	{
+		int slot = (Head + Count) & 3;
+		if (Count == 4)
+			Head = (Head + 1) & 3;
+		else
+			Count++;
+		Ring[slot][0] = x;
+		Ring[slot][1] = y;
+	}
+
+	// the span from sample 1 to sample 2 as a cubic: the Catmull-Rom tangents are
+	// (p2 - p0) / 2 and (p3 - p1) / 2, a third of which gives the inner control points
+	int emit(std::vector<float>& out)
+	{
+		const float* p0 = sample(0);
+		const float* p1 = sample(1);
+		const float* p2 = sample(2);
+		const float* p3 = sample(3);
+		float c[8];
+		for (int k = 0; k < 2; k++) {
+			c[k] = p1[k];
+			c[k + 2] = p1[k] + (p2[k] - p0[k]) / 6.0f;
+			c[k + 4] = p2[k] - (p3[k] - p1[k]) / 6.0f;
+			c[k + 6] = p2[k];
+		}
+		int points = flattenCubic(c, Tolerance, ScaleX, ScaleY, Span);
+		// the first vertex is the end of the previous span, already in out
+		out.insert(out.end(), Span.begin() + 2, Span.end());
+		return points - 1;
+	}
+
+	StrokeBuilder(const StrokeBuilder&);
+	StrokeBuilder& operator=(const StrokeBuilder&);
+};
+#endif